@@ -0,0 +1,137 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef BARRIER_HPP_INCLUDED
+#define BARRIER_HPP_INCLUDED
+
+// Headers
+#include <TTL/Ttldef/Ttldef.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Lets a fixed set of threads wait for each other
+    ///
+    /// Every thread that calls wait is held until all threads
+    /// have called it, after which the barrier is ready for the
+    /// next phase. Arrivals are counted without a lock; waiting
+    /// threads spin for a while before they go to sleep.
+    ///
+    /// The last arrival touches the barrier no more once the
+    /// others can see it arrive, so the barrier may be destroyed
+    /// as soon as every other thread has returned from wait.
+    ///
+    ////////////////////////////////////////////////////////////
+    class Barrier
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param threads The amount of threads that meet at the
+        /// barrier, at least 1
+        /// \param spin_count The amount of times wait() checks for
+        /// the last arrival before it goes to sleep
+        ///
+        ////////////////////////////////////////////////////////////
+        Barrier(const Sti_t threads, const Sti_t spin_count = 0);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Wait until every thread has arrived
+        ///
+        /// \return true on exactly one thread per phase, the last
+        /// one to arrive
+        ///
+        ////////////////////////////////////////////////////////////
+        bool wait();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of threads that meet at the barrier
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getThreadCount() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the spin budget of wait()
+        ///
+        /// \see Flare::setSpinCount
+        ///
+        ////////////////////////////////////////////////////////////
+        void setSpinCount(const Sti_t spin_count);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the spin budget of wait()
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getSpinCount() const;
+
+    private:
+
+        const Sti_t m_threads; ///< Threads that meet at the barrier
+        std::atomic<Sti_t> m_remaining; ///< Threads yet to arrive in this phase
+        std::atomic<Sti_t> m_state; ///< The sense in the low bits, above them the threads sleeping on m_cndvar
+        std::atomic<Sti_t> m_spin_count; ///< Checks for the last arrival before sleeping
+        std::mutex m_mx; ///< Guards sleeping on the condition variable
+        std::condition_variable m_cndvar; ///< Wakes sleeping threads after the last arrival
+
+    };
+
+} // Namespace ttl
+
+#endif // BARRIER_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class Barrier
+/// \ingroup Thread Utilities
+///
+/// \code
+/// // Four threads take turns computing and exchanging halos
+/// ttl::Barrier barrier(4, 1000);
+/// auto step = [&](std::size_t index)
+/// {
+///     for (int t = 0; t < 1000; ++t)
+///     {
+///         computeInterior(index);
+///         barrier.wait();
+///         exchangeHalo(index);
+///         if (barrier.wait()) // One thread
+///         {
+///             ++timestep;
+///         }
+///     }
+/// };
+/// \endcode
+///
+/// The barrier is sense-reversing: every thread remembers the
+/// sense of the phase it arrived in, and leaves once the last
+/// arrival flips it. The count is reset before the flip, so
+/// the barrier can be reused at once, phase after phase.
+///
+/// BatchWorker::parallel runs one function on every thread of
+/// a pool, and hands them a barrier of the right size.
+///
+////////////////////////////////////////////////////////////
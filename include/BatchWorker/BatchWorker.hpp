@@ -23,15 +23,30 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 
 // Headers
 #include <thread>
+#include <algorithm>
+#include <iterator>
 #include <TTL/Ttldef/Ttldef.hpp>
 #include <TTL/Sleep/Sleep.hpp>
+#include <TTL/Barrier/Barrier.hpp>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include <cassert>
 #include <iostream>
 #include <TTL/Flare/Flare.hpp>
+#include <TTL/Future/Future.hpp>
+#include <TTL/Job/Job.hpp>
 #include <TTL/Worker/Worker.hpp>
 #include <TTL/Bool/Bool.hpp>
+#include <TTL/Padded/Padded.hpp>
 
 
 namespace ttl
@@ -45,6 +60,28 @@ namespace ttl
     {
     public:
 
+        ////////////////////////////////////////////////////////////
+        /// \brief How fer and fir divide a range among workers
+        ///
+        ////////////////////////////////////////////////////////////
+        enum class Schedule
+        {
+            Strided, ///< Worker i visits elements i, i + N, i + 2N, ...
+            Contiguous, ///< Worker i visits a single contiguous block
+            Stealing ///< Idle workers steal chunks from busy workers
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Where the workers may run
+        ///
+        ////////////////////////////////////////////////////////////
+        enum class Affinity
+        {
+            None, ///< Anywhere the operating system likes
+            Node, ///< Worker i runs on the NUMA node of the i-th cpu
+            Core ///< Worker i runs on the i-th cpu only
+        };
+
         ////////////////////////////////////////////////////////////
         /// \brief Constructor
         ///
@@ -60,339 +97,1345 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         /// \brief Destructor
         ///
+        /// Waits for every function given to issueWork, including
+        /// the ones they issue in turn, and stops the workers.
+        ///
         ////////////////////////////////////////////////////////////
         ~BatchWorker();
 
         ////////////////////////////////////////////////////////////
         /// \brief Set the amount of workers
         ///
+        /// Waits for every function given to issueWork first, so
+        /// it must not be called from one.
+        ///
         ////////////////////////////////////////////////////////////
         void setWorkerCount(const Sti_t workers);
 
         ////////////////////////////////////////////////////////////
         /// \brief Get the amount of workers
         ///
+        /// When elastic, this is the amount of workers currently
+        /// in use, between the core and maximum counts.
+        ///
         ////////////////////////////////////////////////////////////
         Sti_t getWorkerCount() const;
 
         ////////////////////////////////////////////////////////////
-        /// \brief Parallel for with thread IDs.
-        ///
-        ////////////////////////////////////////////////////////////
-        template <typename ITERATOR, typename FUNCTION>
-        void fir(ITERATOR begin, ITERATOR end, FUNCTION fun, bool wait_for_all = true, bool main_contribute = true, const Sti_t advance = 1)
+        /// \brief How the pool grows and shrinks
+        ///
+        ////////////////////////////////////////////////////////////
+        struct Elasticity
+        {
+            Sti_t core; ///< Workers that are always kept
+            Sti_t maximum; ///< Workers that may exist at once
+            Sti_t threshold; ///< Functions waiting per worker that start another worker
+            std::chrono::milliseconds idle_timeout; ///< How long an extra worker idles before its thread exits
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Let the pool grow and shrink with load
+        ///
+        /// Waits for every function given to issueWork first, so
+        /// it must not be called from one.
+        ///
+        /// The pool keeps the core workers, and starts more, up to
+        /// the maximum, when functions given to issueWork pile up.
+        /// An extra worker whose thread has idled for the timeout
+        /// stops its thread, and the pool shrinks again.
+        ///
+        /// Loops use the workers that are in use when they start,
+        /// so a burst of single functions also speeds up the
+        /// loops that follow it.
+        ///
+        /// setWorkerCount turns this off again.
+        ///
+        ////////////////////////////////////////////////////////////
+        void setElasticity(const Elasticity &elasticity);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get how the pool grows and shrinks
+        ///
+        ////////////////////////////////////////////////////////////
+        Elasticity getElasticity() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the most workers that were in use at once
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getPeakWorkerCount() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if the calling thread is one of the workers
+        ///
+        /// Such a thread must not block on work it issues to this
+        /// pool, which could be queued behind it.
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isWorkerThread() const
+        {
+            return current_worker.pool == this;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set how long threads spin before sleeping
+        ///
+        /// Applies to the workers waiting for work, and to the
+        /// caller waiting for the workers. Spinning makes short
+        /// back-to-back loops a lot faster, at the cost of cpu
+        /// time while idle.
+        ///
+        /// \see Flare::setSpinCount
+        ///
+        ////////////////////////////////////////////////////////////
+        void setSpinCount(const Sti_t spin_count);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get how long threads spin before sleeping
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getSpinCount() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set how fer and fir divide a range
+        ///
+        /// Contiguous and stealing scheduling only apply to
+        /// random-access iterators, all other iterators are
+        /// always strided.
+        ///
+        ////////////////////////////////////////////////////////////
+        void setSchedule(const Schedule schedule);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get how fer and fir divide a range
+        ///
+        ////////////////////////////////////////////////////////////
+        Schedule getSchedule() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the granularity of contiguous blocks
+        ///
+        /// Every block starts at a multiple of grain visited
+        /// elements. A grain of 0 uses as many elements as fit in
+        /// a cache line, so that neighbouring blocks never write
+        /// into the same line.
+        ///
+        /// When stealing, grain is the size of a stolen chunk.
+        /// A grain of 0 then picks a chunk size that gives each
+        /// worker a few dozen chunks.
+        ///
+        ////////////////////////////////////////////////////////////
+        void setGrainSize(const Sti_t grain);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the granularity of contiguous blocks
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getGrainSize() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the fewest elements worth giving to a thread
+        ///
+        /// Waking a worker costs about as much as a few thousand
+        /// cheap loop iterations. Loops then use only as many
+        /// threads as can each get this many elements, and loops
+        /// over fewer elements run on the calling thread alone,
+        /// without waking any worker. Applies to every loop and
+        /// algorithm, whatever the schedule.
+        ///
+        /// The right size depends on the cost of the loop body;
+        /// bench measures it for a cheap body. The default of 0
+        /// always uses every worker.
+        ///
+        ////////////////////////////////////////////////////////////
+        void setMinimumBlockSize(const Sti_t elements);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the fewest elements worth giving to a thread
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getMinimumBlockSize() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Pin the workers to cpus or NUMA nodes
+        ///
+        /// Cpus are counted node by node, so workers with
+        /// neighbouring IDs, which get neighbouring contiguous
+        /// blocks, share a node. With more workers than cpus,
+        /// the cpus are reused. The calling thread is left alone.
+        /// Workers added later are pinned too.
+        ///
+        /// Only supported on Linux.
+        ///
+        /// \return true if every worker was moved
+        ///
+        ////////////////////////////////////////////////////////////
+        bool setAffinity(const Affinity affinity);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get where the workers may run
+        ///
+        ////////////////////////////////////////////////////////////
+        Affinity getAffinity() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Wait for a loop that was not waited for
+        ///
+        /// Waits, at most for timeout, for the workers of the last
+        /// loop that was called with wait_for_all false. Must be
+        /// called from the thread that called the loop.
+        ///
+        /// \return false if the timeout passed first; the next
+        /// loop then still waits for the workers before it starts
+        ///
+        ////////////////////////////////////////////////////////////
+        bool waitFor(const std::chrono::nanoseconds timeout);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Stop the running loop early
+        ///
+        /// Can be called from a loop body, or from any other
+        /// thread. Every thread finishes the element it is
+        /// visiting, and visits no further elements of the fer or
+        /// fir loop that is running. The next loop starts afresh.
+        ///
+        ////////////////////////////////////////////////////////////
+        void cancel();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if the running loop has been cancelled
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isCancelled() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel for with thread IDs.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename FUNCTION>
+        void fir(ITERATOR begin, ITERATOR end, FUNCTION fun, bool wait_for_all = true, bool main_contribute = true, const Sti_t advance = 1)
+        {
+            static_assert(is_iterator<ITERATOR>::value, "Arguments begin and end are not valid iterators.");
+            if (begin == end)
+            {
+                return;
+            }
+            this->forEach(begin, end, fun, wait_for_all, main_contribute, advance);
+        }
+
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel for.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename FUNCTION>
+        void fer(ITERATOR begin, ITERATOR end, FUNCTION fun, bool wait_for_all = true, bool main_contribute = true, const Sti_t advance = 1)
+        {
+            static_assert(is_iterator<ITERATOR>::value, "Arguments begin and end are not valid iterators.");
+            if (begin == end)
+            {
+                return;
+            }
+            this->forEach(begin, end, DiscardId<FUNCTION>{fun}, wait_for_all, main_contribute, advance);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel for.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename FUNCTION>
+        void fer2(ITERATOR begin, ITERATOR end, FUNCTION fun, bool wait_for_all = true, bool main_contribute = true, const Sti_t advance = 1)
+        {
+            static_assert(is_iterator<ITERATOR>::value, "Arguments begin and end are not valid iterators.");
+            if (begin == end)
+            {
+                return;
+            }
+
+            const Caller caller(*this);
+            this->forEachStrided(caller, begin, end, DiscardId<FUNCTION>{fun}, wait_for_all, main_contribute, advance);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel reduction
+        ///
+        /// Combines all elements and init with op, like
+        /// std::reduce. op must be associative, it need not be
+        /// commutative: elements are combined in order.
+        ///
+        /// \return The combination of init and every element
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename T, typename OPERATION>
+        T reduce(ITERATOR begin, ITERATOR end, T init, OPERATION op)
+        {
+            return this->transformReduce(begin, end, std::move(init), op, Identity());
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel transformation and reduction
+        ///
+        /// Transforms every element and combines the results and
+        /// init with reduce, like std::transform_reduce. reduce
+        /// must be associative, it need not be commutative.
+        ///
+        /// Every thread reduces one contiguous block into its own
+        /// cache line, after which the partial results are
+        /// combined pairwise.
+        ///
+        /// \return The combination of init and every transformed
+        /// element
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename T, typename REDUCE, typename TRANSFORM>
+        T transformReduce(ITERATOR begin, ITERATOR end, T init, REDUCE reduce, TRANSFORM transform)
+        {
+            static_assert(is_random_access<ITERATOR>::value, "Arguments begin and end are not random-access iterators.");
+            const Sti_t count(std::distance(begin, end));
+            if (count == 0)
+            {
+                return init;
+            }
+
+            const Caller caller(*this);
+            const Sti_t workers = this->getUsefulWorkerCount(caller, count, true);
+            const Sti_t block = getBlockSize(count, workers + 1, this->getEffectiveGrainSize<typename std::iterator_traits<ITERATOR>::value_type>());
+            const Sti_t blocks = (count + block - 1) / block;
+            std::vector<Padded<T>> partials(blocks, Padded<T>(init));
+
+            auto work = [&begin, &reduce, &transform, &partials, block, count](const Sti_t index, const Sti_t) -> void
+            {
+                ITERATOR first(begin), last(begin);
+                std::advance(first, index * block);
+                std::advance(last, std::min(index * block + block, count));
+                T partial(transform(*first));
+                for (++first; first != last; ++first)
+                {
+                    partial = reduce(std::move(partial), transform(*first));
+                }
+                *partials[index] = std::move(partial);
+            };
+            this->forEachBlock(caller, blocks, work, true, true, workers);
+
+            for (Sti_t step(1); step < blocks; step *= 2)
+            {
+                for (Sti_t i(0); i + step < blocks; i += 2 * step)
+                {
+                    *partials[i] = reduce(std::move(*partials[i]), std::move(*partials[i + step]));
+                }
+            }
+            return reduce(std::move(init), std::move(*partials[0]));
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel inclusive prefix scan
+        ///
+        /// Writes op(x0, x1, ..., xi) to the i-th output, like
+        /// std::inclusive_scan. out may equal begin. op must be
+        /// associative.
+        ///
+        /// \return The end of the output range
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename OUTPUT, typename OPERATION>
+        OUTPUT inclusiveScan(ITERATOR begin, ITERATOR end, OUTPUT out, OPERATION op)
+        {
+            if (begin == end)
+            {
+                return out;
+            }
+            typename std::iterator_traits<ITERATOR>::value_type first(*begin);
+            return this->scan<true>(begin, end, out, std::move(first), op);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel exclusive prefix scan
+        ///
+        /// Writes op(init, x0, ..., xi-1) to the i-th output, like
+        /// std::exclusive_scan. out may equal begin. op must be
+        /// associative.
+        ///
+        /// \return The end of the output range
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename OUTPUT, typename T, typename OPERATION>
+        OUTPUT exclusiveScan(ITERATOR begin, ITERATOR end, OUTPUT out, T init, OPERATION op)
+        {
+            return this->scan<false>(begin, end, out, std::move(init), op);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel search
+        ///
+        /// Finds the first element for which pred returns true,
+        /// like std::find_if. The threads take chunks in order, and
+        /// stop as soon as every element before a match has been
+        /// checked, so an early match ends the search early.
+        ///
+        /// \return The first matching element, or end
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename PREDICATE>
+        ITERATOR findIf(ITERATOR begin, ITERATOR end, PREDICATE pred)
+        {
+            return begin + this->find<true>(begin, end, pred);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel check for any match
+        ///
+        /// Like std::any_of. All threads stop at the first match
+        /// found by any of them.
+        ///
+        /// \return true if pred returns true for any element
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename PREDICATE>
+        bool anyOf(ITERATOR begin, ITERATOR end, PREDICATE pred)
+        {
+            return this->find<false>(begin, end, pred) != static_cast<Sti_t>(std::distance(begin, end));
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Run one function on every thread at once
+        ///
+        /// Calls fun(index, threads, barrier) once on each worker
+        /// and on the calling thread, with index counting from 0
+        /// to threads - 1, and waits for all of them. The barrier
+        /// is shared by exactly these threads, so a job of many
+        /// phases can synchronise between them without returning
+        /// to the caller every time.
+        ///
+        /// Every call must reach the same barrier waits. Nested
+        /// in a loop on the same pool, fun runs once, alone.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename FUNCTION>
+        void parallel(FUNCTION fun)
+        {
+            const Caller caller(*this);
+            const Sti_t threads = this->getAvailableWorkerCount(caller) + 1;
+            Barrier barrier(threads, m_spin_count);
+            auto work = [&fun, &barrier, threads](const Sti_t index, const Sti_t) -> void
+            {
+                fun(index, threads, barrier);
+            };
+            this->forEachBlock(caller, threads, work, true, true, threads - 1);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Run a single function on one of the workers
+        ///
+        /// Functions are handed to the workers in turn, and are not
+        /// waited for by fer, fir or wait. Can be called from any
+        /// thread, including from within the function itself. A
+        /// full queue passes the function on to the next worker,
+        /// and when all are full this call yields until one makes
+        /// room. Only when there are no workers, or when a worker
+        /// of this pool finds every queue full, which it could
+        /// otherwise wait on forever, does the function run on the
+        /// calling thread instead.
+        ///
+        /// When elastic, another worker is started whenever the
+        /// functions waiting to start exceed the threshold.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename T>
+        void issueWork(T function)
+        {
+            Job job(this->makeJob(std::move(function)));
+            while (this->tryIssueJob(job) == false)
+            {
+                if (m_thread_pool.empty() || current_worker.pool == this)
+                {
+                    job();
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Run a single function on one of the workers, unless all are busy
+        ///
+        /// Like issueWork, but never waits nor runs the function
+        /// on the calling thread.
+        ///
+        /// \return true if the function was queued, false if there
+        /// are no workers or every queue is full
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename T>
+        bool tryIssueWork(T function)
+        {
+            Job job(this->makeJob(std::move(function)));
+            if (this->tryIssueJob(job))
+            {
+                return true;
+            }
+            --m_backlog;
+            --m_unfinished; // The pool's own count keeps it above 0
+            return false;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Run a single function, and put its return value in a future
+        ///
+        /// \see issueWork, Future
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename T, typename FUNCTION>
+        void issueWork(Future<T> &future, FUNCTION function)
+        {
+            Promise<T> promise(future.getPromise());
+            this->issueWork([promise, function]() mutable {promise.setValueFrom(function);});
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Start a loop that the calling thread does not wait for
+        ///
+        /// For awaitables that suspend instead of blocking, like
+        /// the one of the coroutine fer. The pool is taken like by
+        /// any loop, and the cancellation reset, while the loop is
+        /// sized for count elements of ITERATOR and started. plan
+        /// gets the amount of helpers and the block size before
+        /// any of them runs. Every helper, given to issueWork, and
+        /// then the calling thread run work as a participant of
+        /// the loop, so PerWorker and nested loops behave as in
+        /// fer. A helper then runs finish, no longer a participant,
+        /// while the calling thread returns. Where a loop would
+        /// run by itself, there are no helpers.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename PLAN, typename WORK, typename FINISH>
+        void issueLoop(const Sti_t count, PLAN plan, WORK work, FINISH finish)
+        {
+            const Caller caller(*this);
+            Sti_t helpers(this->getUsefulWorkerCount(caller, count, true));
+            const Sti_t block(this->getScheduledBlockSize<ITERATOR>(count, helpers + 1));
+            const Sti_t blocks((count + block - 1) / block);
+            helpers = std::min(helpers, blocks > 0 ? blocks - 1 : 0);
+            plan(helpers, block);
+            if (caller.isInline() == false)
+            {
+                this->settle();
+                m_cancelled.store(false, std::memory_order_relaxed);
+            }
+            for (Sti_t i(0); i < helpers; ++i)
+            {
+                this->issueWork
+                (
+                    [work, finish, this]() mutable
+                    {
+                        {
+                            ParticipantScope scope(this, this->getParticipantId());
+                            work();
+                        }
+                        finish();
+                    }
+                );
+            }
+            ParticipantScope scope(this, caller.getId());
+            work();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel sort
+        ///
+        /// Sorts the range with cmp, like std::sort. Every thread
+        /// sorts one contiguous block, after which neighbouring
+        /// runs are merged pairwise until one run remains. Every
+        /// merge is split evenly among the threads, no matter how
+        /// the values are distributed.
+        ///
+        /// The elements must be default constructible and move
+        /// assignable, a buffer as large as the range is used to
+        /// merge into. The sort is not stable.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename COMPARE>
+        void sort(ITERATOR begin, ITERATOR end, COMPARE cmp)
+        {
+            static_assert(is_random_access<ITERATOR>::value, "Arguments begin and end are not random-access iterators.");
+            typedef typename std::iterator_traits<ITERATOR>::value_type T;
+            const Sti_t count(std::distance(begin, end));
+            const Caller caller(*this);
+            const Sti_t workers = this->getUsefulWorkerCount(caller, count, true);
+            const Sti_t block = std::max(getBlockSize(count, workers + 1, this->getEffectiveGrainSize<T>()), static_cast<Sti_t>(min_sort_block));
+            if (count <= block)
+            {
+                std::sort(begin, end, cmp);
+                return;
+            }
+            const Sti_t blocks = (count + block - 1) / block;
+
+            auto sort_block = [&begin, &cmp, block, count](const Sti_t index, const Sti_t) -> void
+            {
+                std::sort(begin + index * block, begin + std::min(index * block + block, count), cmp);
+            };
+            this->forEachBlock(caller, blocks, sort_block, true, true, workers);
+
+            std::vector<T> buffer(count);
+            bool in_buffer = false;
+            for (Sti_t width(block); width < count; width *= 2)
+            {
+                if (in_buffer)
+                {
+                    this->mergeRuns(caller, buffer.begin(), begin, count, width, block, cmp, workers);
+                }
+                else
+                {
+                    this->mergeRuns(caller, begin, buffer.begin(), count, width, block, cmp, workers);
+                }
+                in_buffer = !in_buffer;
+            }
+
+            if (in_buffer)
+            {
+                auto move_block = [&begin, &buffer, block, count](const Sti_t index, const Sti_t) -> void
+                {
+                    std::move(buffer.begin() + index * block, buffer.begin() + std::min(index * block + block, count), begin + index * block);
+                };
+                this->forEachBlock(caller, blocks, move_block, true, true, workers);
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Parallel sort in ascending order
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        void sort(ITERATOR begin, ITERATOR end)
+        {
+            this->sort(begin, end, std::less<typename std::iterator_traits<ITERATOR>::value_type>());
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief One value per thread of a BatchWorker
+        ///
+        /// Every value is copied from the prototype the first time
+        /// its thread asks for it, on that thread, and lives on
+        /// its own cache line. The values are kept across loops
+        /// until clear is called.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename T>
+        class PerWorker
+        {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            /// \brief Constructor
+            ///
+            /// There is room for every worker the pool may have,
+            /// and for the thread that calls the loops. The
+            /// storage must be recreated after setWorkerCount or
+            /// setElasticity.
+            ///
+            ////////////////////////////////////////////////////////////
+            PerWorker(const BatchWorker &pool, T prototype)
+            :
+                m_pool(&pool),
+                m_prototype(std::move(prototype)),
+                m_values(pool.m_thread_pool.size() + 1)
+            {}
+
+            ////////////////////////////////////////////////////////////
+            /// \brief Get the value of the calling thread
+            ///
+            /// Called from a loop body, or from a function given to
+            /// issueWork, this is the value of the thread running
+            /// it. Any other thread gets the value of the caller
+            /// of the loops, so only one such thread may use it.
+            ///
+            /// \throw std::out_of_range if the pool has more workers
+            /// than when the storage was created
+            ///
+            ////////////////////////////////////////////////////////////
+            T &local()
+            {
+                const Sti_t id = m_pool->getParticipantId();
+                if (id >= m_values.size())
+                {
+                    throw std::out_of_range("PerWorker::local, the pool was resized after the storage was created");
+                }
+                std::unique_ptr<Padded<T>> &value = m_values[id];
+                if (value == nullptr)
+                {
+                    value.reset(new Padded<T>(m_prototype));
+                }
+                return **value;
+            }
+
+            ////////////////////////////////////////////////////////////
+            /// \brief Visit every value that has been created
+            ///
+            /// Must not run during a loop that uses the values.
+            ///
+            ////////////////////////////////////////////////////////////
+            template <typename FUNCTION>
+            void forEach(FUNCTION fun)
+            {
+                for (std::unique_ptr<Padded<T>> &value : m_values)
+                {
+                    if (value != nullptr)
+                    {
+                        fun(**value);
+                    }
+                }
+            }
+
+            ////////////////////////////////////////////////////////////
+            /// \brief Combine every value that has been created
+            ///
+            /// Must not run during a loop that uses the values.
+            ///
+            /// \return The combination of init and every value, in
+            /// the order of the thread IDs
+            ///
+            ////////////////////////////////////////////////////////////
+            template <typename U, typename OPERATION>
+            U combine(U init, OPERATION op)
+            {
+                this->forEach([&init, &op](T &value){init = op(std::move(init), value);});
+                return init;
+            }
+
+            ////////////////////////////////////////////////////////////
+            /// \brief Destroy every value
+            ///
+            ////////////////////////////////////////////////////////////
+            void clear()
+            {
+                for (std::unique_ptr<Padded<T>> &value : m_values)
+                {
+                    value.reset();
+                }
+            }
+
+        private:
+
+            const BatchWorker *m_pool; ///< The pool whose threads own the values
+            T m_prototype; ///< Copied into every new value
+            std::vector<std::unique_ptr<Padded<T>>> m_values; ///< Indexed by thread ID, nullptr until first used
+
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Create storage with one value per thread
+        ///
+        /// \see PerWorker
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename T>
+        PerWorker<T> perWorker(T prototype = T()) const
+        {
+            return PerWorker<T>(*this, std::move(prototype));
+        }
+
+    private:
+
+        ////////////////////////////////////////////////////////////
+        template<typename T, typename = void>
+        struct is_iterator
+        {static constexpr bool value = false;};
+
+        ////////////////////////////////////////////////////////////
+        template<typename T>
+        struct is_iterator<T, typename std::enable_if<!std::is_same<typename std::iterator_traits<T>::value_type, void>::value>::type>
+        {static constexpr bool value = true;};
+
+        ////////////////////////////////////////////////////////////
+        template <typename T>
+        struct is_random_access
+        {static constexpr bool value = std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<T>::iterator_category>::value;};
+
+        ////////////////////////////////////////////////////////////
+        struct Identity
+        {
+            template <typename T>
+            T &&operator()(T &&t) const
+            {
+                return std::forward<T>(t);
+            }
+        };
+
+        ////////////////////////////////////////////////////////////
+        template <typename FUNCTION>
+        struct DiscardId
+        {
+            template <typename T>
+            void operator()(T &&element, const Sti_t) const
+            {
+                fun(std::forward<T>(element));
+            }
+
+            mutable FUNCTION fun;
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// The thread that starts a loop, and whether it may hand
+        /// out blocks to the workers or runs the loop by itself.
+        /// Within a block of a running loop it runs the loop by
+        /// itself. A worker that runs a function given to
+        /// issueWork does too, unless it can take the pool for
+        /// itself at once, since the thread holding the pool may
+        /// be waiting for this worker. Other threads wait for the
+        /// pool. Held until the loop returns.
+        ///
+        ////////////////////////////////////////////////////////////
+        class Caller
+        {
+        public:
+
+            explicit Caller(BatchWorker &pool);
+            ~Caller();
+
+            Caller(const Caller &) = delete;
+            Caller &operator=(const Caller &) = delete;
+
+            bool isInline() const
+            {
+                return m_inline;
+            }
+
+            Sti_t getId() const
+            {
+                return m_id;
+            }
+
+        private:
+
+            BatchWorker &m_pool; ///< The pool the loop runs on
+            Sti_t m_id; ///< The thread ID the caller's blocks run with
+            bool m_inline; ///< Whether the whole loop runs on the calling thread
+            bool m_owns; ///< Whether m_pool's batch mutex is held
+
+        };
+
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename FUNCTION>
+        void forEach(ITERATOR begin, ITERATOR end, FUNCTION fun, bool wait_for_all, bool main_contribute, const Sti_t advance)
+        {
+            const Caller caller(*this);
+            if (m_schedule == Schedule::Contiguous)
+            {
+                this->forEachContiguous(caller, begin, end, fun, wait_for_all, main_contribute, advance, typename std::iterator_traits<ITERATOR>::iterator_category());
+            }
+            else if (m_schedule == Schedule::Stealing)
+            {
+                this->forEachStealing(caller, begin, end, fun, wait_for_all, main_contribute, advance, typename std::iterator_traits<ITERATOR>::iterator_category());
+            }
+            else
+            {
+                this->forEachStrided(caller, begin, end, fun, wait_for_all, main_contribute, advance);
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename FUNCTION>
+        void forEachStrided(const Caller &caller, ITERATOR begin, ITERATOR end, const FUNCTION &fun, bool wait_for_all, bool main_contribute, const Sti_t advance)
+        {
+            if (caller.isInline())
+            {
+                FUNCTION inline_fun(fun);
+                for (Sti_t i(0); begin != end && this->isCancelled() == false; ++begin, ++i)
+                {
+                    if (i % advance == 0)
+                    {
+                        inline_fun( *begin, caller.getId() );
+                    }
+                }
+                return;
+            }
+
+            // Counting the elements is linear for some iterators
+            const Sti_t thread_pool_size(m_min_block > 1 ? this->getUsefulWorkerCount(caller, (static_cast<Sti_t>(std::distance(begin, end)) + advance - 1) / advance, main_contribute) : this->getAvailableWorkerCount(caller));
+            const Sti_t advancepertps = (thread_pool_size + (main_contribute ? 1 : 0)) * advance;
+            const std::atomic<bool> *cancelled(&m_cancelled);
+            auto work = [begin, end, advance, advancepertps, cancelled, fun](const Sti_t offset, const Sti_t id) mutable -> void
+            {
+                const Sti_t advanceperi = offset * advance;
+
+                ITERATOR start(begin);
+                if (static_cast<Sti_t>(std::distance(start, end)) > advanceperi && cancelled->load(std::memory_order_relaxed) == false)
+                {
+                    std::advance(start, advanceperi);
+                    fun( *start, id );
+
+                    while (static_cast<Sti_t>(std::distance(start, end)) > advancepertps && cancelled->load(std::memory_order_relaxed) == false)
+                    {
+                        std::advance(start, advancepertps);
+                        fun( *start, id );
+                    }
+                }
+            };
+
+            this->beginBatch(thread_pool_size, wait_for_all);
+            this->issue(this->share(work, thread_pool_size, wait_for_all), thread_pool_size, caller.getId());
+            if (main_contribute)
+            {
+                ParticipantScope scope(this, caller.getId());
+                work(thread_pool_size, caller.getId());
+            }
+            if (wait_for_all && thread_pool_size > 0)
+            {
+                this->wait();
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename FUNCTION, typename CATEGORY>
+        void forEachContiguous(const Caller &caller, ITERATOR begin, ITERATOR end, FUNCTION &fun, bool wait_for_all, bool main_contribute, const Sti_t advance, CATEGORY)
+        {
+            this->forEachStrided(caller, begin, end, fun, wait_for_all, main_contribute, advance);
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename FUNCTION>
+        void forEachContiguous(const Caller &caller, ITERATOR begin, ITERATOR end, FUNCTION &fun, bool wait_for_all, bool main_contribute, const Sti_t advance, std::random_access_iterator_tag)
+        {
+            const Sti_t count = (static_cast<Sti_t>(std::distance(begin, end)) + advance - 1) / advance;
+            const Sti_t thread_pool_size(this->getUsefulWorkerCount(caller, count, main_contribute));
+            const Sti_t participants = thread_pool_size + (main_contribute ? 1 : 0);
+            if (participants == 0)
+            {
+                return;
+            }
+
+            const Sti_t block = getBlockSize(count, participants, this->getEffectiveGrainSize<typename std::iterator_traits<ITERATOR>::value_type>());
+            const Sti_t blocks = (count + block - 1) / block;
+
+            const std::atomic<bool> *cancelled(&m_cancelled);
+            auto work = [begin, advance, block, count, cancelled, fun](const Sti_t index, const Sti_t id) mutable -> void
+            {
+                const Sti_t first = index * block;
+                visitChunk(begin, first, std::min(first + block, count), advance, *cancelled, fun, id);
+            };
+            this->forEachBlock(caller, blocks, work, wait_for_all, main_contribute, thread_pool_size);
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename FUNCTION>
+        static void visitChunk(ITERATOR begin, const Sti_t first, const Sti_t last, const Sti_t advance, const std::atomic<bool> &cancelled, FUNCTION &fun, const Sti_t id)
+        {
+            if (first < last)
+            {
+                ITERATOR start(begin);
+                std::advance(start, first * advance);
+                for (Sti_t i(first + 1); i < last && cancelled.load(std::memory_order_relaxed) == false; ++i)
+                {
+                    fun( *start, id );
+                    std::advance(start, advance);
+                }
+                if (cancelled.load(std::memory_order_relaxed) == false)
+                {
+                    fun( *start, id );
+                }
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <bool FIRST, typename ITERATOR, typename PREDICATE>
+        Sti_t find(ITERATOR begin, ITERATOR end, PREDICATE &pred)
+        {
+            static_assert(is_random_access<ITERATOR>::value, "Arguments begin and end are not random-access iterators.");
+            const Sti_t count(std::distance(begin, end));
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            // Chunks are taken in order, so once a match is found,
+            // every chunk before it has already been taken
+            const Sti_t chunk = m_grain != 0 ? m_grain : find_chunk;
+            const Caller caller(*this);
+            const Sti_t workers = this->getUsefulWorkerCount(caller, count, true);
+            const Sti_t blocks = std::min(workers + 1, (count + chunk - 1) / chunk);
+            std::atomic<Sti_t> next(0), found(count);
+
+            auto work = [&begin, &pred, &next, &found, chunk, count](const Sti_t, const Sti_t) -> void
+            {
+                for (;;)
+                {
+                    const Sti_t first = next.fetch_add(1, std::memory_order_relaxed) * chunk;
+                    const Sti_t last = std::min(first + chunk, count);
+                    for (Sti_t i(first); i < last; ++i)
+                    {
+                        const Sti_t best = found.load(std::memory_order_relaxed);
+                        if (FIRST ? i >= best : best != count)
+                        {
+                            return;
+                        }
+                        if (pred(begin[i]))
+                        {
+                            Sti_t current(best);
+                            while (i < current && found.compare_exchange_weak(current, i, std::memory_order_relaxed) == false);
+                            return;
+                        }
+                    }
+                    if (last == count)
+                    {
+                        return;
+                    }
+                }
+            };
+            this->forEachBlock(caller, blocks, work, true, true, workers);
+            return found.load(std::memory_order_relaxed);
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <bool INCLUSIVE, typename ITERATOR, typename OUTPUT, typename T, typename OPERATION>
+        OUTPUT scan(ITERATOR begin, ITERATOR end, OUTPUT out, T init, OPERATION &op)
+        {
+            static_assert(is_random_access<ITERATOR>::value, "Arguments begin and end are not random-access iterators.");
+            static_assert(is_random_access<OUTPUT>::value, "Argument out is not a random-access iterator.");
+            const Sti_t count(std::distance(begin, end));
+            if (count == 0)
+            {
+                return out;
+            }
+
+            const Caller caller(*this);
+            const Sti_t workers = this->getUsefulWorkerCount(caller, count, true);
+            const Sti_t block = getBlockSize(count, workers + 1, this->getEffectiveGrainSize<typename std::iterator_traits<OUTPUT>::value_type>());
+            const Sti_t blocks = (count + block - 1) / block;
+            std::vector<Padded<T>> carries(blocks, Padded<T>(init));
+
+            // Up-sweep: the total of every block but the last
+            auto reduce_block = [&begin, &op, &carries, block, blocks](const Sti_t index, const Sti_t) -> void
+            {
+                if (index + 1 == blocks)
+                {
+                    return;
+                }
+                ITERATOR first(begin), last(begin);
+                std::advance(first, index * block);
+                std::advance(last, index * block + block);
+                T partial(*first);
+                for (++first; first != last; ++first)
+                {
+                    partial = op(std::move(partial), *first);
+                }
+                *carries[index + 1] = std::move(partial);
+            };
+            this->forEachBlock(caller, blocks, reduce_block, true, true, workers);
+
+            // What precedes each block
+            for (Sti_t i(1); i < blocks; ++i)
+            {
+                if (INCLUSIVE == false || i > 1)
+                {
+                    *carries[i] = op(*carries[i - 1], std::move(*carries[i]));
+                }
+            }
+
+            // Down-sweep: scan every block starting from its carry
+            auto scan_block = [&begin, &out, &op, &carries, block, count](const Sti_t index, const Sti_t) -> void
+            {
+                ITERATOR first(begin), last(begin);
+                OUTPUT destination(out);
+                std::advance(first, index * block);
+                std::advance(last, std::min(index * block + block, count));
+                std::advance(destination, index * block);
+                T carry(std::move(*carries[index]));
+                if (INCLUSIVE && index == 0)
+                {
+                    *destination = carry;
+                    ++first;
+                    ++destination;
+                }
+                for (; first != last; ++first, ++destination)
+                {
+                    if (INCLUSIVE)
+                    {
+                        carry = op(std::move(carry), *first);
+                        *destination = carry;
+                    }
+                    else
+                    {
+                        T element(*first);
+                        *destination = carry;
+                        carry = op(std::move(carry), std::move(element));
+                    }
+                }
+            };
+            this->forEachBlock(caller, blocks, scan_block, true, true, workers);
+
+            std::advance(out, count);
+            return out;
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <typename SOURCE, typename DESTINATION, typename COMPARE>
+        void mergeRuns(const Caller &caller, SOURCE source, DESTINATION destination, const Sti_t count, const Sti_t width, const Sti_t block, COMPARE &cmp, const Sti_t workers)
+        {
+            // Pairs of runs start at multiples of 2 * width, which
+            // is a multiple of block, so every block of the output
+            // belongs to a single pair
+            auto merge_block = [&source, &destination, &cmp, count, width, block](const Sti_t index, const Sti_t) -> void
+            {
+                const Sti_t pair = index * block / (2 * width) * (2 * width);
+                const SOURCE a(source + pair), b(source + std::min(pair + width, count));
+                const Sti_t a_size = std::min(pair + width, count) - pair;
+                const Sti_t b_size = std::min(pair + 2 * width, count) - pair - a_size;
+                const Sti_t first = index * block - pair;
+                const Sti_t last = std::min(first + block, a_size + b_size);
+                const Sti_t a_first = coRank(first, a, a_size, b, b_size, cmp);
+                const Sti_t a_last = coRank(last, a, a_size, b, b_size, cmp);
+                std::merge
+                (
+                    std::make_move_iterator(a + a_first), std::make_move_iterator(a + a_last),
+                    std::make_move_iterator(b + (first - a_first)), std::make_move_iterator(b + (last - a_last)),
+                    destination + index * block, cmp
+                );
+            };
+            this->forEachBlock(caller, (count + block - 1) / block, merge_block, true, true, workers);
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR, typename COMPARE>
+        static Sti_t coRank(const Sti_t rank, const ITERATOR a, const Sti_t a_size, const ITERATOR b, const Sti_t b_size, COMPARE &cmp)
+        {
+            // How many of the first rank merged elements come from
+            // a, where equal elements of a precede those of b
+            Sti_t low = rank > b_size ? rank - b_size : 0;
+            Sti_t high = std::min(rank, a_size);
+            while (low < high)
+            {
+                const Sti_t middle = low + (high - low) / 2;
+                if (cmp(b[rank - middle - 1], a[middle]))
+                {
+                    high = middle;
+                }
+                else
+                {
+                    low = middle + 1;
+                }
+            }
+            return low;
+        }
+
+        ////////////////////////////////////////////////////////////
+        static Sti_t getBlockSize(const Sti_t count, const Sti_t participants, const Sti_t grain)
+        {
+            return ((count + participants - 1) / participants + grain - 1) / grain * grain;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// Sizes the blocks of a loop that participants take in
+        /// turn, one per participant, or stealing's smaller chunks
+        /// if reaching a chunk is cheap
+        template <typename ITERATOR>
+        Sti_t getScheduledBlockSize(const Sti_t count, const Sti_t participants)
         {
-            static_assert(is_iterator<ITERATOR>::value, "Arguments begin and end are not valid iterators.");
-            if (begin == end)
+            typedef typename std::iterator_traits<ITERATOR>::value_type T;
+            if (m_schedule == Schedule::Stealing && is_random_access<ITERATOR>::value)
             {
-                return;
+                return m_grain != 0 ? m_grain : std::max(this->getEffectiveGrainSize<T>(), count / (participants * 32));
             }
+            return std::max(getBlockSize(count, participants, this->getEffectiveGrainSize<T>()), Sti_t(1));
+        }
 
-            const Sti_t thread_pool_size(m_thread_pool.size());
-            if (m_has_waited.fetchAndSet(wait_for_all) == false)
-            {
-                this->wait();
-            }
-            m_actively_working += thread_pool_size;
-            if (wait_for_all == false) // Then main can exit the function, descoping the references
-            {
-                for (Sti_t i(0); i < thread_pool_size; ++i)
-                {
-                    this->issueWorkManualIncrement
-                    (
-                        [i, thread_pool_size, begin, end, fun, advance, main_contribute]() -> void
-                        {
-                            Sti_t advanceperi = i * advance;
-
-                            ITERATOR start(begin);
-                            if (std::distance(start, end) > advanceperi)
-                            {
-                                std::advance(start, advanceperi);
-                                fun( *start, i );
-
-                                Sti_t advancepertps = (thread_pool_size + (main_contribute ? 1 : 0)) * advance;
-                                while (std::distance(start, end) > advancepertps)
-                                {
-                                    std::advance(start, advancepertps);
-                                    fun( *start, i );
-                                }
-                            }
-                        },
-                        i
-                    );
-                }
-            }
-            else // We can rest assured; and take references.
+        ////////////////////////////////////////////////////////////
+        template <typename WORK>
+        void forEachBlock(const Caller &caller, const Sti_t blocks, WORK &work, bool wait_for_all, bool main_contribute, const Sti_t thread_pool_size)
+        {
+            if (caller.isInline())
             {
-                for (Sti_t i(0); i < thread_pool_size; ++i)
+                for (Sti_t i(0); i < blocks; ++i)
                 {
-                    this->issueWorkManualIncrement
-                    (
-                        [i, &thread_pool_size, &begin, &end, &fun, &advance, &main_contribute]() -> void
-                        {
-                            Sti_t advanceperi = i * advance;
-
-                            ITERATOR start(begin);
-                            if (std::distance(start, end) > advanceperi)
-                            {
-                                std::advance(start, advanceperi);
-                                fun( *start, i );
-
-                                Sti_t advancepertps = (thread_pool_size + (main_contribute ? 1 : 0)) * advance;
-                                while (std::distance(start, end) > advancepertps)
-                                {
-                                    std::advance(start, advancepertps);
-                                    fun( *start, i );
-                                }
-                            }
-                        },
-                        i
-                    );
+                    work(i, caller.getId());
                 }
+                return;
             }
-            if (main_contribute)
-            {
-                Sti_t advanceperi = (thread_pool_size) * advance;
 
-                ITERATOR start(begin);
-                if (std::distance(start, end) > advanceperi)
-                {
-                    std::advance(start, advanceperi);
-                    fun( *start, thread_pool_size );
+            // The blocks were sized for thread_pool_size, which must not be read again:
+            // a retiring elastic worker could make it smaller and leave blocks without a thread
+            const Sti_t workers = main_contribute ? std::min(thread_pool_size, blocks - 1) : blocks;
+            assert(workers + (main_contribute ? 1 : 0) >= blocks && workers <= thread_pool_size && "Every block needs a thread");
 
-                    Sti_t advancepertps = (thread_pool_size + 1) * advance;
-                    while (std::distance(start, end) > advancepertps)
-                    {
-                        std::advance(start, advancepertps);
-                        fun( *start, thread_pool_size );
-                    }
-                }
+            this->beginBatch(workers, wait_for_all);
+            this->issue(this->share(work, workers, wait_for_all), workers, caller.getId());
+            if (main_contribute && workers < blocks)
+            {
+                ParticipantScope scope(this, caller.getId());
+                work(workers, caller.getId());
             }
-            if (wait_for_all)
+            if (wait_for_all && workers > 0)
             {
                 this->wait();
             }
-
         }
 
+        ////////////////////////////////////////////////////////////
+        template <typename T>
+        Sti_t getEffectiveGrainSize() const
+        {
+            if (m_grain != 0)
+            {
+                return m_grain;
+            }
+            return sizeof(T) < cache_line_size ? cache_line_size / sizeof(T) : 1;
+        }
 
         ////////////////////////////////////////////////////////////
-        /// \brief Parallel for.
-        ///
+        template <typename ITERATOR, typename FUNCTION, typename CATEGORY>
+        void forEachStealing(const Caller &caller, ITERATOR begin, ITERATOR end, FUNCTION &fun, bool wait_for_all, bool main_contribute, const Sti_t advance, CATEGORY)
+        {
+            this->forEachStrided(caller, begin, end, fun, wait_for_all, main_contribute, advance);
+        }
+
         ////////////////////////////////////////////////////////////
         template <typename ITERATOR, typename FUNCTION>
-        void fer(ITERATOR begin, ITERATOR end, FUNCTION fun, bool wait_for_all = true, bool main_contribute = true, const Sti_t advance = 1)
+        void forEachStealing(const Caller &caller, ITERATOR begin, ITERATOR end, FUNCTION &fun, bool wait_for_all, bool main_contribute, const Sti_t advance, std::random_access_iterator_tag)
         {
-            static_assert(is_iterator<ITERATOR>::value, "Arguments begin and end are not valid iterators.");
-            if (begin == end)
+            if (caller.isInline()) // The deques belong to the loop that is running
             {
+                this->forEachStrided(caller, begin, end, fun, wait_for_all, main_contribute, advance);
                 return;
             }
 
-            const Sti_t thread_pool_size(m_thread_pool.size());
-            if (m_has_waited.fetchAndSet(wait_for_all) == false)
+            const Sti_t count = (static_cast<Sti_t>(std::distance(begin, end)) + advance - 1) / advance;
+            const Sti_t thread_pool_size(this->getUsefulWorkerCount(caller, count, main_contribute));
+            const Sti_t participants = thread_pool_size + (main_contribute ? 1 : 0);
+            if (participants == 0)
             {
-                this->wait();
+                return;
             }
-            m_actively_working += thread_pool_size;
-            if (wait_for_all == false) // Then main can exit the function, descoping the references
+
+            Sti_t chunk = m_grain;
+            if (chunk == 0)
             {
-                for (Sti_t i(0); i < thread_pool_size; ++i)
-                {
-                    this->issueWorkManualIncrement
-                    (
-                        [i, thread_pool_size, begin, end, fun, advance, main_contribute]() -> void
-                        {
-                            Sti_t advanceperi = i * advance;
-
-                            ITERATOR start(begin);
-                            if (std::distance(start, end) > advanceperi)
-                            {
-                                std::advance(start, advanceperi);
-                                fun( *start );
-
-                                Sti_t advancepertps = (thread_pool_size + (main_contribute ? 1 : 0)) * advance;
-                                while (std::distance(start, end) > advancepertps)
-                                {
-                                    std::advance(start, advancepertps);
-                                    fun( *start );
-                                }
-                            }
-                        },
-                        i
-                    );
-                }
+                chunk = std::max(this->getEffectiveGrainSize<typename std::iterator_traits<ITERATOR>::value_type>(), count / (participants * 32));
             }
-            else // We can rest assured; and take references.
+            chunk = std::max(chunk, count / max_chunks + 1);
+            const Sti_t chunks = (count + chunk - 1) / chunk;
+            const Sti_t workers = std::min(thread_pool_size, main_contribute ? chunks - 1 : chunks);
+            const Sti_t deques = workers + (main_contribute ? 1 : 0);
+
+            this->beginBatch(workers, wait_for_all);
+            for (Sti_t i(0); i < deques; ++i)
             {
-                for (Sti_t i(0); i < thread_pool_size; ++i)
-                {
-                    this->issueWorkManualIncrement
-                    (
-                        [i, &thread_pool_size, &begin, &end, &fun, &advance, &main_contribute]() -> void
-                        {
-                            Sti_t advanceperi = i * advance;
-
-                            ITERATOR start(begin);
-                            if (std::distance(start, end) > advanceperi)
-                            {
-                                std::advance(start, advanceperi);
-                                fun( *start );
-
-                                Sti_t advancepertps = (thread_pool_size + (main_contribute ? 1 : 0)) * advance;
-                                while (std::distance(start, end) > advancepertps)
-                                {
-                                    std::advance(start, advancepertps);
-                                    fun( *start );
-                                }
-                            }
-                        },
-                        i
-                    );
-                }
+                m_deques[i]->store(packRange(i * chunks / deques, (i + 1) * chunks / deques));
             }
-            if (main_contribute)
-            {
-                Sti_t advanceperi = (thread_pool_size) * advance;
 
-                ITERATOR start(begin);
-                if (std::distance(start, end) > advanceperi)
+            Padded<std::atomic<std::uint64_t>> *const ranges = m_deques.get();
+            const std::atomic<bool> *cancelled(&m_cancelled);
+            auto work = [begin, advance, chunk, count, ranges, deques, cancelled, fun](const Sti_t self, const Sti_t id) mutable -> void
+            {
+                Sti_t index;
+                do
                 {
-                    std::advance(start, advanceperi);
-                    fun( *start );
-
-                    Sti_t advancepertps = (thread_pool_size + 1) * advance;
-                    while (std::distance(start, end) > advancepertps)
+                    while (takeChunk(*ranges[self], index))
                     {
-                        std::advance(start, advancepertps);
-                        fun( *start );
+                        const Sti_t first = index * chunk;
+                        visitChunk(begin, first, std::min(first + chunk, count), advance, *cancelled, fun, id);
                     }
                 }
+                while (stealChunks(ranges, deques, self) && cancelled->load(std::memory_order_relaxed) == false);
+            };
+
+            this->issue(this->share(work, workers, wait_for_all), workers, caller.getId());
+            if (main_contribute)
+            {
+                ParticipantScope scope(this, caller.getId());
+                work(workers, caller.getId());
             }
-            if (wait_for_all)
+            if (wait_for_all && workers > 0)
             {
                 this->wait();
             }
         }
 
         ////////////////////////////////////////////////////////////
-        /// \brief Parallel for.
-        ///
+        static std::uint64_t packRange(const Sti_t first, const Sti_t last)
+        {
+            return static_cast<std::uint64_t>(first) << 32 | static_cast<std::uint64_t>(last);
+        }
+
         ////////////////////////////////////////////////////////////
-        template <typename ITERATOR, typename FUNCTION>
-        void fer2(ITERATOR begin, ITERATOR end, FUNCTION fun, bool wait_for_all = true, bool main_contribute = true, const Sti_t advance = 1)
+        static bool takeChunk(std::atomic<std::uint64_t> &range, Sti_t &chunk);
+
+        ////////////////////////////////////////////////////////////
+        static bool stealChunks(Padded<std::atomic<std::uint64_t>> *ranges, const Sti_t count, const Sti_t thief);
+
+        ////////////////////////////////////////////////////////////
+        void beginBatch(const Sti_t workers, bool wait_for_all)
         {
-            static_assert(is_iterator<ITERATOR>::value, "Arguments begin and end are not valid iterators.");
-            if (begin == end)
-            {
-                return;
-            }
+            this->settle();
+            m_has_waited = wait_for_all || workers == 0;
+            m_cancelled.store(false, std::memory_order_relaxed);
+        }
+
+        ////////////////////////////////////////////////////////////
+        void settle();
+
+        ////////////////////////////////////////////////////////////
+        struct Detached
+        {
+            virtual ~Detached() = default;
+        };
 
-            const Sti_t thread_pool_size(m_thread_pool.size());
-            if (m_has_waited.fetchAndSet(wait_for_all) == false)
+        ////////////////////////////////////////////////////////////
+        template <typename WORK>
+        struct DetachedWork : Detached
+        {
+            DetachedWork(const WORK &work) : work(work) {}
+            WORK work;
+        };
+
+        ////////////////////////////////////////////////////////////
+        template <typename WORK>
+        WORK &share(WORK &work, const Sti_t workers, bool wait_for_all)
+        {
+            if (wait_for_all || workers == 0) // We can rest assured; and take references.
             {
-                this->wait();
+                return work;
             }
-            m_actively_working += thread_pool_size;
-            if (wait_for_all == false) // Then main can exit the function, descoping the references
+            // Then main can exit the function, descoping the references
+            typedef DetachedWork<WORK> Holder;
+            Holder *holder;
+            m_detached_inline = sizeof(Holder) <= sizeof(m_detached_storage) && alignof(Holder) <= alignof(DetachedStorage);
+            if (m_detached_inline)
             {
-                for (Sti_t i(0); i < thread_pool_size; ++i)
-                {
-                    this->issueWorkManualIncrement
-                    (
-                        [i, thread_pool_size, begin, end, fun, advance, main_contribute]() -> void
-                        {
-                            Sti_t advanceperi = i * advance;
-
-                            ITERATOR start(begin);
-                            if (std::distance(start, end) > advanceperi)
-                            {
-                                start += advanceperi;
-                                fun( *start );
-
-                                Sti_t advancepertps = (thread_pool_size + (main_contribute ? 1 : 0)) * advance;
-                                while (std::distance(start, end) > advancepertps)
-                                {
-                                    start += advancepertps;
-                                    fun( *start );
-                                }
-                            }
-                        },
-                        i
-                    );
-                }
+                holder = new (&m_detached_storage) Holder(work);
             }
-            else // We can rest assured; and take references.
+            else
             {
-                for (Sti_t i(0); i < thread_pool_size; ++i)
-                {
-                    this->issueWorkManualIncrement
-                    (
-                        [i, &thread_pool_size, &begin, &end, &fun, &advance, &main_contribute]() -> void
-                        {
-                            Sti_t advanceperi = i * advance;
-
-                            ITERATOR start(begin);
-                            if (std::distance(start, end) > advanceperi)
-                            {
-                                start += advanceperi;
-                                fun( *start );
-
-                                Sti_t advancepertps = (thread_pool_size + (main_contribute ? 1 : 0)) * advance;
-                                while (std::distance(start, end) > advancepertps)
-                                {
-                                    start += advancepertps;
-                                    fun( *start );
-                                }
-                            }
-                        },
-                        i
-                    );
-                }
+                holder = new Holder(work);
             }
-            if (main_contribute)
-            {
-                Sti_t advanceperi = (thread_pool_size) * advance;
-
-                ITERATOR start(begin);
-                if (std::distance(start, end) > advanceperi)
-                {
-                    start += advanceperi;
-                    fun( *start );
+            m_detached = holder;
+            return holder->work;
+        }
 
-                    Sti_t advancepertps = (thread_pool_size + 1) * advance;
-                    while (std::distance(start, end) > advancepertps)
-                    {
-                        start += advancepertps;
-                        fun( *start );
-                    }
-                }
-            }
-            if (wait_for_all)
+        ////////////////////////////////////////////////////////////
+        template <typename WORK>
+        void issue(WORK &work, const Sti_t workers, const Sti_t caller)
+        {
+            m_actively_working += workers;
+            for (Sti_t i(0); i < workers; ++i)
             {
-                this->wait();
+                // A calling worker runs its own block, and is skipped
+                const Sti_t worker = i < caller ? i : i + 1;
+                this->issueWorkManualIncrement
+                (
+                    [&work, i, worker, this]() -> void
+                    {
+                        ParticipantScope scope(this, worker);
+                        work(i, worker);
+                    }, worker
+                );
             }
         }
 
-    private:
-
-        ////////////////////////////////////////////////////////////
-        template<typename T, typename = void>
-        struct is_iterator
-        {static constexpr bool value = false;};
-
-        ////////////////////////////////////////////////////////////
-        template<typename T>
-        struct is_iterator<T, typename std::enable_if<!std::is_same<typename std::iterator_traits<T>::value_type, void>::value>::type>
-        {static constexpr bool value = true;};
-
         ////////////////////////////////////////////////////////////
         template <typename T>
-        void issueWorkManualIncrement(const T t, const Sti_t thread)
+        void issueWorkManualIncrement(T t, const Sti_t thread)
         {
             m_thread_pool[thread]->issueWork
             (
-                [t, this]()
+                [t, this]() mutable
                 {
                     t();
                     if (m_actively_working.fetch_sub(1) == 1)
@@ -403,14 +1446,159 @@ namespace ttl
             );
         }
 
+        ////////////////////////////////////////////////////////////
+        template <typename T>
+        Job makeJob(T function)
+        {
+            ++m_backlog;
+            ++m_unfinished;
+            return Job
+            (
+                [function, this]() mutable
+                {
+                    --m_backlog;
+                    function();
+                    if (m_unfinished.fetch_sub(1) == 1)
+                    {
+                        m_idle.notify(); // Last access, the pool may be gone after this
+                    }
+                }
+            );
+        }
+
+        ////////////////////////////////////////////////////////////
+        void drain();
+
+        ////////////////////////////////////////////////////////////
+        bool tryIssueJob(Job &job);
+
         ////////////////////////////////////////////////////////////
         void wait();
 
         ////////////////////////////////////////////////////////////
-        std::vector<std::unique_ptr<Worker>> m_thread_pool; ///< Collection of workers
+        bool applyAffinity();
+
+        ////////////////////////////////////////////////////////////
+        void resize();
+
+        ////////////////////////////////////////////////////////////
+        Sti_t getActiveWorkerCount();
+
+        ////////////////////////////////////////////////////////////
+        Sti_t addActiveWorker(Sti_t active);
+
+        ////////////////////////////////////////////////////////////
+        Sti_t getAvailableWorkerCount(const Caller &caller)
+        {
+            if (caller.isInline())
+            {
+                return 0;
+            }
+            const Sti_t active(this->getActiveWorkerCount());
+            return caller.getId() < active ? active - 1 : active;
+        }
+
+        ////////////////////////////////////////////////////////////
+        Sti_t getUsefulWorkerCount(const Caller &caller, const Sti_t count, bool main_contribute)
+        {
+            return this->limitWorkerCount(this->getAvailableWorkerCount(caller), count, main_contribute);
+        }
+
+        ////////////////////////////////////////////////////////////
+        Sti_t limitWorkerCount(const Sti_t workers, const Sti_t count, bool main_contribute) const
+        {
+            if (m_min_block <= 1)
+            {
+                return workers;
+            }
+            const Sti_t useful = (count + m_min_block - 1) / m_min_block;
+            return std::min(workers, main_contribute ? useful - 1 : std::max(useful, Sti_t(1)));
+        }
+
+        ////////////////////////////////////////////////////////////
+        struct Participant
+        {
+            const BatchWorker *pool;
+            Sti_t id;
+        };
+
+        ////////////////////////////////////////////////////////////
+        class ParticipantScope
+        {
+        public:
+
+            ParticipantScope(const BatchWorker *pool, const Sti_t id)
+            :
+                m_previous(current_participant)
+            {
+                current_participant = {pool, id};
+            }
+
+            ~ParticipantScope()
+            {
+                current_participant = m_previous;
+            }
+
+        private:
+
+            Participant m_previous;
+
+        };
+
+        ////////////////////////////////////////////////////////////
+        bool isNested(Sti_t &id) const
+        {
+            if (current_participant.pool != this)
+            {
+                return false;
+            }
+            id = current_participant.id;
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////
+        Sti_t getParticipantId() const
+        {
+            Sti_t id;
+            if (this->isNested(id))
+            {
+                return id;
+            }
+            return current_worker.pool == this ? current_worker.id : m_thread_pool.size();
+        }
+
+        ////////////////////////////////////////////////////////////
+        std::vector<std::unique_ptr<Worker>> m_thread_pool; ///< Collection of workers, the first m_active are in use
+        std::atomic<Sti_t> m_active; ///< Workers in use, the others are retired
+        std::atomic<Sti_t> m_peak; ///< Most workers in use at once
+        std::atomic<Sti_t> m_backlog; ///< Single functions that have been issued but not started
+        std::atomic<Sti_t> m_unfinished; ///< Single functions that have not finished, plus one held by the pool
+        ttl::Flare m_idle; ///< Notified by the function that finishes last once drain gave up the pool's count
+        Elasticity m_elasticity; ///< How the pool grows and shrinks
         std::atomic<Sti_t> m_actively_working; ///< Counter of actively working workers
         ttl::Flare m_threads_done; ///< Notified when all threads have finished.
         Bool m_has_waited;
+        Sti_t m_spin_count; ///< Spin budget of every flare in the pool
+        Schedule m_schedule; ///< How ranges are divided among workers
+        Sti_t m_grain; ///< Granularity of contiguous blocks, 0 for a cache line
+        Sti_t m_min_block; ///< Fewest elements worth giving to a thread
+        std::atomic<Sti_t> m_next_worker; ///< The worker that receives the next single function
+        Affinity m_affinity; ///< Where the workers may run
+        std::atomic<bool> m_cancelled; ///< Whether the running loop should stop
+        std::unique_ptr<Padded<std::atomic<std::uint64_t>>[]> m_deques; ///< Packed [first, last) chunk range of each participant when stealing
+        std::recursive_mutex m_batch_mutex; ///< Held by the thread whose loop hands out blocks
+
+        typedef std::aligned_storage<256, alignof(std::max_align_t)>::type DetachedStorage;
+        DetachedStorage m_detached_storage; ///< Holds the work of an unwaited batch, if it fits
+        Detached *m_detached; ///< The work of an unwaited batch, or nullptr
+        bool m_detached_inline; ///< Whether m_detached lives in m_detached_storage
+
+        static constexpr Sti_t max_chunks = 0xFFFFFFFF; ///< Chunk indices must fit in half of a packed range
+        static constexpr Sti_t min_sort_block = 1 << 12; ///< Smaller blocks are not worth merging
+        static constexpr Sti_t find_chunk = 1 << 11; ///< Elements a thread searches before checking for an earlier match
+
+        static thread_local Participant current_participant; ///< The pool and id this thread runs a block for, if any
+        static thread_local Participant current_worker; ///< The pool and id of the worker that owns this thread, if any
 
     };
 
@@ -512,4 +1700,167 @@ namespace ttl
 /// If advance = 3, then 0, 3, 6, 9,... will be run.
 /// 0 is an included multiple.
 ///
+/// By default, each thread visits every N-th element, where
+/// N is the amount of threads. On random-access ranges it is
+/// usually faster to give each thread one contiguous block,
+/// so that threads stream through memory and never write
+/// into each other's cache lines:
+///
+/// \code
+/// std::vector<float> v(1 << 24);
+/// ttl::BatchWorker w(8);
+/// w.setSchedule(ttl::BatchWorker::Schedule::Contiguous);
+/// w.setGrainSize(1024); // Blocks start at multiples of 1024 elements
+/// w.fer(v.begin(), v.end(), [](float &f){f = 1.f;});
+/// \endcode
+///
+/// Blocks never get smaller than the grain size, so small
+/// ranges wake fewer workers. Iterators that are not
+/// random-access are always strided.
+///
+/// Sums and other reductions have their own functions,
+/// which keep each thread's partial result on its own cache
+/// line:
+///
+/// \code
+/// std::vector<double> v(1000000, 0.5);
+/// double sum = w.reduce(v.begin(), v.end(), 0.0, std::plus<double>());
+/// double squares = w.transformReduce
+/// (
+///     v.begin(), v.end(), 0.0, std::plus<double>(),
+///     [](double d){return d * d;}
+/// );
+/// \endcode
+///
+/// Prefix sums are computed in two parallel passes over
+/// contiguous blocks, with inclusiveScan and exclusiveScan:
+///
+/// \code
+/// std::vector<int> sizes = {3, 1, 4, 1, 5};
+/// std::vector<int> offsets(sizes.size());
+/// w.exclusiveScan(sizes.begin(), sizes.end(), offsets.begin(), 0, std::plus<int>());
+/// // offsets is now {0, 3, 4, 8, 9}
+/// \endcode
+///
+/// When the cost per element varies a lot, use
+/// Schedule::Stealing. The range is cut into chunks, and
+/// every thread starts on its own contiguous run of chunks.
+/// Threads that run out of chunks steal half of the
+/// remaining chunks of another thread, so one slow element
+/// no longer holds up the whole batch.
+///
+/// Searches need not visit the whole range. findIf returns
+/// the first match as soon as everything before it has been
+/// checked, and anyOf stops at any match. Other loops can be
+/// stopped from their body with cancel:
+///
+/// \code
+/// auto it = w.findIf(v.begin(), v.end(), [](double d){return d > 1.0;});
+/// w.fer
+/// (
+///     rows.begin(), rows.end(), [&w](const Row &row)
+///     {
+///         if (row.isCorrupt())
+///         {
+///             w.cancel(); // No further rows are visited
+///         }
+///     }
+/// );
+/// if (w.isCancelled()) { ... }
+/// \endcode
+///
+/// A service with bursts of single functions need not keep
+/// every thread around in between:
+///
+/// \code
+/// ttl::BatchWorker w;
+/// // 4 workers at all times, up to 64 when more than 8
+/// // functions per worker wait, extra threads exit after
+/// // idling for a second
+/// w.setElasticity({4, 64, 8, std::chrono::seconds(1)});
+/// w.issueWork([]{handleRequest();});
+/// std::cout << w.getWorkerCount() << " of at most " << w.getPeakWorkerCount() << std::endl;
+/// \endcode
+///
+/// On machines with several sockets, pin the workers so
+/// that a block stays in the same cache, and on the same
+/// NUMA node, from one loop to the next. A contiguous loop
+/// over the same range always gives worker i the same block,
+/// so initialise the data with such a loop too; every page
+/// is then first touched, and placed, by the thread that
+/// keeps using it:
+///
+/// \code
+/// ttl::BatchWorker w(std::thread::hardware_concurrency() - 1);
+/// w.setAffinity(ttl::BatchWorker::Affinity::Core);
+/// w.setSchedule(ttl::BatchWorker::Schedule::Contiguous);
+/// std::unique_ptr<float[]> data(new float[1 << 26]); // Not yet touched
+/// w.fer(data.get(), data.get() + (1 << 26), [](float &f){f = 0.f;});
+/// for (int step = 0; step < 100; ++step)
+/// {
+///     w.fer(data.get(), data.get() + (1 << 26), [](float &f){f += 1.f;});
+/// }
+/// \endcode
+///
+/// Scratch space that a loop body needs on every call is
+/// best kept per thread, and reused by later loops:
+///
+/// \code
+/// auto buffers = w.perWorker<std::vector<float>>();
+/// auto counts = w.perWorker<std::size_t>(0);
+/// w.fer
+/// (
+///     images.begin(), images.end(), [&](Image &image)
+///     {
+///         std::vector<float> &buffer = buffers.local();
+///         buffer.resize(image.size()); // Allocates only while it grows
+///         counts.local() += image.blur(buffer);
+///     }
+/// );
+/// std::size_t total = counts.combine(std::size_t(0), std::plus<std::size_t>());
+/// \endcode
+///
+/// Iterative solvers that would call fer once per timestep
+/// can run all steps in one go instead, meeting at a barrier
+/// between phases:
+///
+/// \code
+/// w.parallel
+/// (
+///     [&](std::size_t index, std::size_t threads, ttl::Barrier &barrier)
+///     {
+///         const std::size_t first = cells.size() * index / threads;
+///         const std::size_t last = cells.size() * (index + 1) / threads;
+///         for (int step = 0; step < 10000; ++step)
+///         {
+///             update(cells, next, first, last);
+///             barrier.wait();
+///             std::copy(next.begin() + first, next.begin() + last, cells.begin() + first);
+///             barrier.wait();
+///         }
+///     }
+/// );
+/// \endcode
+///
+/// Loops may be nested. When a loop body calls fer, fir,
+/// reduce, scan or sort on the same BatchWorker, the inner
+/// call runs serially on the thread that made it, using that
+/// thread's ID. The outer loop already keeps every thread
+/// busy, so nothing is lost, and nothing waits on itself:
+///
+/// \code
+/// std::vector<std::vector<int>> partitions(64, std::vector<int>(1000));
+/// w.fer
+/// (
+///     partitions.begin(), partitions.end(), [&w](std::vector<int> &partition)
+///     {
+///         w.sort(partition.begin(), partition.end());
+///     }
+/// );
+/// \endcode
+///
+/// A function given to issueWork may start loops of its own,
+/// which are spread over the other workers while no other
+/// loop runs. If one does, the loop runs serially instead.
+///
 ////////////////////////////////////////////////////////////
@@ -0,0 +1,221 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef CONTENTION_HPP_INCLUDED
+#define CONTENTION_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+#if defined(TTL_CONTENTION)
+    #define TTL_CONTENTION_SCOPE(x) x
+#else
+    #define TTL_CONTENTION_SCOPE(x)
+#endif // TTL_CONTENTION
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Counts how contended a lock or signal is
+    ///
+    /// Synched and Flare own one each when TTL_CONTENTION is
+    /// defined for the whole build, and nothing otherwise. Every
+    /// live Contention registers itself, so getReport can list
+    /// them all. Counters are relaxed atomics and only meant to
+    /// be read as a report.
+    ///
+    ////////////////////////////////////////////////////////////
+    class Contention
+    {
+    public:
+
+        typedef std::chrono::steady_clock Clock;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief A copy of the counters at one point in time
+        ///
+        /// Times are in nanoseconds.
+        ///
+        ////////////////////////////////////////////////////////////
+        struct Counts
+        {
+            Sti_t reads = 0; ///< Shared acquisitions
+            Sti_t writes = 0; ///< Exclusive acquisitions, or Flare waits
+            Sti_t timeouts = 0; ///< Timed acquisitions that gave up
+            Sti_t notifications = 0; ///< Flare notifications
+            Sti_t read_wait = 0; ///< Total time readers waited
+            Sti_t write_wait = 0; ///< Total time writers (or Flare waiters) waited
+            Sti_t max_wait = 0; ///< Longest single wait
+            Sti_t max_hold = 0; ///< Longest exclusive hold
+            Sti_t max_readers = 0; ///< Most readers seen at once
+
+            Counts &operator+=(const Counts &counts);
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param kind What is being counted, like "Synched"
+        /// \param name Shown in the report, objects with the same
+        /// name are added together.
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit Contention(const char *kind, const std::string &name = "unnamed");
+
+        Contention(const Contention &) = delete;
+        Contention &operator=(const Contention &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        /// Removes this object, and its counts, from the report.
+        ///
+        ////////////////////////////////////////////////////////////
+        ~Contention();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Count a shared acquisition
+        ///
+        /// \param wait How long it took to get access
+        /// \param readers The amount of readers after this one
+        /// got access
+        ///
+        ////////////////////////////////////////////////////////////
+        void addRead(const Clock::duration wait, const Sti_t readers);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Count an exclusive acquisition
+        ///
+        /// \param wait How long it took to get access
+        ///
+        ////////////////////////////////////////////////////////////
+        void addWrite(const Clock::duration wait);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Count the release of an exclusive acquisition
+        ///
+        /// \param hold How long access was held
+        ///
+        ////////////////////////////////////////////////////////////
+        void addHold(const Clock::duration hold);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Count a timed acquisition that gave up
+        ///
+        ////////////////////////////////////////////////////////////
+        void addTimeout();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Count a notification of a signal
+        ///
+        ////////////////////////////////////////////////////////////
+        void addNotification();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get a copy of the counters
+        ///
+        ////////////////////////////////////////////////////////////
+        Counts getCounts() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set all counters to 0
+        ///
+        ////////////////////////////////////////////////////////////
+        void reset();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the name shown in the report
+        ///
+        ////////////////////////////////////////////////////////////
+        void setName(const std::string &name);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the name shown in the report
+        ///
+        ////////////////////////////////////////////////////////////
+        std::string getName() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Write the counters of every live object
+        ///
+        /// One line per kind and name, the most waited on first.
+        /// Writes nothing when nothing is registered, as is the
+        /// case without TTL_CONTENTION.
+        ///
+        ////////////////////////////////////////////////////////////
+        static void writeReport(std::ostream &out);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the report of writeReport as a string
+        ///
+        ////////////////////////////////////////////////////////////
+        static std::string getReport();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the counters of every live object to 0
+        ///
+        ////////////////////////////////////////////////////////////
+        static void resetAll();
+
+    private:
+
+        static void raise(std::atomic<Sti_t> &maximum, const Sti_t value);
+
+        const char *const m_kind; ///< What is being counted
+        std::string m_name; ///< Guarded by the registry's mutex
+        std::atomic<Sti_t> m_reads, m_writes, m_timeouts, m_notifications;
+        std::atomic<Sti_t> m_read_wait, m_write_wait, m_max_wait, m_max_hold, m_max_readers;
+
+    };
+
+} // Namespace ttl
+
+#endif // CONTENTION_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class Contention
+/// \ingroup Thread Utilities
+///
+/// Build everything, the library included, with TTL_CONTENTION
+/// defined, and name the objects of interest:
+///
+/// \code
+/// ttl::Synched<std::deque<Record>> queue;
+/// queue.setName("ingest queue");
+///
+/// // ... run the workload ...
+///
+/// ttl::Contention::writeReport(std::cerr);
+/// \endcode
+///
+/// Without TTL_CONTENTION, setName does nothing, Synched and
+/// Flare are exactly as large and fast as before, and the
+/// report is empty.
+///
+////////////////////////////////////////////////////////////
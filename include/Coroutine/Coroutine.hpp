@@ -0,0 +1,545 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef COROUTINE_HPP_INCLUDED
+#define COROUTINE_HPP_INCLUDED
+
+// Only available when compiling as C++20 or later
+#ifdef __cpp_impl_coroutine
+
+// Headers
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <TTL/BatchWorker/BatchWorker.hpp>
+#include <TTL/Future/Future.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    template <typename T>
+    class WhenAllAwaiter;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief What every task's promise keeps
+    ///
+    /// A finished task resumes whoever awaits it, counts down
+    /// for whenAll, or sets the future of Task::get.
+    ///
+    ////////////////////////////////////////////////////////////
+    class TaskPromiseBase
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            template <typename PROMISE>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<PROMISE> handle) noexcept
+            {
+                return handle.promise().finish();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        ////////////////////////////////////////////////////////////
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////
+        FinalAwaiter final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        ////////////////////////////////////////////////////////////
+        void unhandled_exception()
+        {
+            m_exception = std::current_exception();
+        }
+
+        ////////////////////////////////////////////////////////////
+        std::coroutine_handle<> finish() noexcept
+        {
+            if (m_done)
+            {
+                Promise<void>(*m_done).setValue(); // Last access, the task may be gone after this
+                return std::noop_coroutine();
+            }
+            if (m_pending && m_pending->fetch_sub(1) != 1)
+            {
+                return std::noop_coroutine();
+            }
+            return m_continuation ? m_continuation : std::noop_coroutine();
+        }
+
+        std::coroutine_handle<> m_continuation; ///< Resumed when the task finishes
+        std::atomic<Sti_t> *m_pending = nullptr; ///< Counted down when the task finishes, m_continuation is resumed at zero
+        Future<void> *m_done = nullptr; ///< Set when the task finishes, for Task::get
+        std::exception_ptr m_exception; ///< Thrown from the task's body
+
+    };
+
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class TaskPromise : public TaskPromiseBase
+    {
+    public:
+
+        template <typename U>
+        void return_value(U &&value)
+        {
+            m_value.emplace(std::forward<U>(value));
+        }
+
+        T takeResult()
+        {
+            if (m_exception)
+            {
+                std::rethrow_exception(m_exception);
+            }
+            return std::move(*m_value);
+        }
+
+    private:
+
+        std::optional<T> m_value; ///< The value given to co_return
+
+    };
+
+    ////////////////////////////////////////////////////////////
+    template <>
+    class TaskPromise<void> : public TaskPromiseBase
+    {
+    public:
+
+        void return_void() const noexcept {}
+
+        void takeResult()
+        {
+            if (m_exception)
+            {
+                std::rethrow_exception(m_exception);
+            }
+        }
+
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief A coroutine that runs once it is awaited
+    ///
+    /// Awaiting a task starts it on the awaiting thread, and
+    /// the awaiter resumes on whichever thread the task
+    /// finishes on. Exceptions propagate to the awaiter.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T = void>
+    class Task
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        struct promise_type : TaskPromise<T>
+        {
+            Task get_return_object() noexcept
+            {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Move ctor
+        ///
+        ////////////////////////////////////////////////////////////
+        Task(Task &&task) noexcept
+        :
+            m_handle(std::exchange(task.m_handle, nullptr))
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Move assignment
+        ///
+        ////////////////////////////////////////////////////////////
+        Task &operator=(Task &&task) noexcept
+        {
+            if (this != &task)
+            {
+                this->destroy();
+                m_handle = std::exchange(task.m_handle, nullptr);
+            }
+            return *this;
+        }
+
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        /// A task must not be destroyed while it runs.
+        ///
+        ////////////////////////////////////////////////////////////
+        ~Task()
+        {
+            this->destroy();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Run the task and block until it finishes
+        ///
+        /// For the outermost task, called from a thread that is
+        /// not one of the pool's workers.
+        ///
+        /// \return What the task returned
+        ///
+        ////////////////////////////////////////////////////////////
+        T get()
+        {
+            Future<void> done;
+            done.getPromise();
+            m_handle.promise().m_done = &done;
+            m_handle.resume();
+            done.wait();
+            return m_handle.promise().takeResult();
+        }
+
+        ////////////////////////////////////////////////////////////
+        bool await_ready() const noexcept
+        {
+            return m_handle.done();
+        }
+
+        ////////////////////////////////////////////////////////////
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+        {
+            m_handle.promise().m_continuation = awaiter;
+            return m_handle;
+        }
+
+        ////////////////////////////////////////////////////////////
+        T await_resume()
+        {
+            return m_handle.promise().takeResult();
+        }
+
+    private:
+
+        template <typename U>
+        friend class WhenAllAwaiter;
+
+        ////////////////////////////////////////////////////////////
+        explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+        :
+            m_handle(handle)
+        {}
+
+        ////////////////////////////////////////////////////////////
+        void destroy()
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        std::coroutine_handle<promise_type> m_handle; ///< The coroutine frame
+
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Awaitable that moves a coroutine onto a worker
+    ///
+    /// \see schedule
+    ///
+    ////////////////////////////////////////////////////////////
+    class ScheduleAwaiter
+    {
+    public:
+
+        explicit ScheduleAwaiter(BatchWorker &pool)
+        :
+            m_pool(pool)
+        {}
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_pool.issueWork([handle]() {handle.resume();});
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+
+        BatchWorker &m_pool; ///< The pool whose worker resumes the coroutine
+
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Awaitable that runs a loop on a pool
+    ///
+    /// \see fer
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename ITERATOR, typename FUNCTION>
+    class ForEachAwaiter
+    {
+    public:
+
+        ForEachAwaiter(BatchWorker &pool, ITERATOR begin, ITERATOR end, FUNCTION function)
+        :
+            m_pool(pool),
+            m_begin(begin),
+            m_count(std::distance(begin, end)),
+            m_block(1),
+            m_blocks(0),
+            m_function(std::move(function))
+        {}
+
+        bool await_ready() const noexcept
+        {
+            return m_count == 0;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            m_next = 0;
+            m_pool.template issueLoop<ITERATOR>
+            (
+                m_count,
+                [this](const Sti_t helpers, const Sti_t block)
+                {
+                    m_block = block;
+                    m_blocks = (m_count + block - 1) / block;
+                    m_pending = helpers + 1;
+                },
+                [this]() {this->run();},
+                [this]()
+                {
+                    if (m_pending.fetch_sub(1) == 1)
+                    {
+                        m_handle.resume();
+                    }
+                }
+            );
+            return m_pending.fetch_sub(1) != 1;
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+
+        void run()
+        {
+            FUNCTION function(m_function);
+            for (Sti_t block(m_next++); block < m_blocks && m_pool.isCancelled() == false; block = m_next++)
+            {
+                ITERATOR first(m_begin);
+                std::advance(first, block * m_block);
+                for (Sti_t i(block * m_block), last(std::min(i + m_block, m_count)); i < last && m_pool.isCancelled() == false; ++i, ++first)
+                {
+                    function(*first);
+                }
+            }
+        }
+
+        BatchWorker &m_pool; ///< The pool that runs the blocks
+        ITERATOR m_begin; ///< The first element
+        Sti_t m_count; ///< The amount of elements
+        Sti_t m_block; ///< The amount of elements per block
+        Sti_t m_blocks; ///< The amount of contiguous blocks
+        FUNCTION m_function; ///< Copied by every participant
+        std::coroutine_handle<> m_handle; ///< Resumed after the last block
+        std::atomic<Sti_t> m_next; ///< The next block to be taken
+        std::atomic<Sti_t> m_pending; ///< Participants that have not yet finished
+
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Awaitable that runs tasks at the same time
+    ///
+    /// \see whenAll
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class WhenAllAwaiter
+    {
+    public:
+
+        explicit WhenAllAwaiter(std::vector<Task<T>> &tasks)
+        :
+            m_tasks(tasks)
+        {}
+
+        bool await_ready() const noexcept
+        {
+            return m_tasks.empty();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_pending = m_tasks.size() + 1;
+            for (Task<T> &task : m_tasks)
+            {
+                task.m_handle.promise().m_continuation = handle;
+                task.m_handle.promise().m_pending = &m_pending;
+                task.m_handle.resume();
+            }
+            return m_pending.fetch_sub(1) != 1;
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+
+        std::vector<Task<T>> &m_tasks; ///< The tasks to start
+        std::atomic<Sti_t> m_pending; ///< Tasks that have not yet finished, plus one while starting
+
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Continue the coroutine on one of the pool's workers
+    ///
+    /// With no workers, the coroutine continues on the
+    /// current thread.
+    ///
+    ////////////////////////////////////////////////////////////
+    inline ScheduleAwaiter schedule(BatchWorker &pool)
+    {
+        return ScheduleAwaiter(pool);
+    }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Parallel for that suspends instead of blocking
+    ///
+    /// Sized like fer: the active workers that are worth using
+    /// for the minimum block size and the awaiting thread take
+    /// contiguous blocks of the grain size in turn, one each, or
+    /// smaller chunks when the pool's schedule is stealing.
+    /// cancel stops it like any loop. Inside a loop of the pool,
+    /// or on a worker while the pool runs another loop, it runs
+    /// on the awaiting thread alone. The coroutine resumes on
+    /// whichever thread finishes last.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename ITERATOR, typename FUNCTION>
+    ForEachAwaiter<ITERATOR, FUNCTION> fer(BatchWorker &pool, ITERATOR begin, ITERATOR end, FUNCTION function)
+    {
+        return ForEachAwaiter<ITERATOR, FUNCTION>(pool, begin, end, std::move(function));
+    }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Run tasks at the same time, and wait for all of them
+    ///
+    /// \return The results, in the order of the tasks
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks)
+    {
+        co_await WhenAllAwaiter<T>(tasks);
+        std::vector<T> results;
+        results.reserve(tasks.size());
+        for (Task<T> &task : tasks)
+        {
+            results.push_back(co_await task);
+        }
+        co_return results;
+    }
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Run tasks at the same time, and wait for all of them
+    ///
+    ////////////////////////////////////////////////////////////
+    inline Task<void> whenAll(std::vector<Task<void>> tasks)
+    {
+        co_await WhenAllAwaiter<void>(tasks);
+        for (Task<void> &task : tasks)
+        {
+            co_await task; // Rethrows
+        }
+    }
+
+} // Namespace ttl
+
+#endif // __cpp_impl_coroutine
+
+#endif // COROUTINE_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class Task
+///
+/// Loading files while computing, without a thread that
+/// blocks on either:
+///
+/// \code
+/// ttl::Task<void> load(ttl::BatchWorker &pool, std::string name, std::string &text)
+/// {
+///     co_await ttl::schedule(pool); // Off the caller's thread
+///     text = ttl::file2str(name);
+/// }
+///
+/// ttl::Task<void> smooth(ttl::BatchWorker &pool, std::vector<float> &v)
+/// {
+///     co_await ttl::schedule(pool);
+///     co_await ttl::fer(pool, v.begin(), v.end(), [](float &f){f *= 0.5f;});
+/// }
+///
+/// ttl::Task<std::size_t> pipeline(ttl::BatchWorker &pool, std::vector<float> &v)
+/// {
+///     std::string a, b;
+///     std::vector<ttl::Task<void>> stages;
+///     stages.push_back(load(pool, "a.txt", a));
+///     stages.push_back(load(pool, "b.txt", b));
+///     stages.push_back(smooth(pool, v));
+///     co_await ttl::whenAll(std::move(stages));
+///     co_return a.size() + b.size();
+/// }
+///
+/// ttl::BatchWorker pool(4);
+/// std::vector<float> v(1 << 20, 1.f);
+/// std::size_t size = pipeline(pool, v).get();
+/// \endcode
+///
+/// Tasks are lazy: nothing runs until a task is awaited, or
+/// get is called on the outermost task.
+///
+////////////////////////////////////////////////////////////
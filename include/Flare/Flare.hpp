@@ -24,6 +24,11 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 // Headers
 #include <mutex> // std::unique_lock, std::mutex
 #include <condition_variable> // std::condition_variable
+#include <atomic> // std::atomic
+#include <chrono> // std::chrono::nanoseconds
+#include <string> // std::string
+#include <TTL/Contention/Contention.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
 
 
 namespace ttl
@@ -35,6 +40,14 @@ namespace ttl
     /// it comes to ownership. It also prevents spurious
     /// wakeups.
     ///
+    /// A waiting thread can optionally spin for a while before
+    /// it goes to sleep, which avoids the cost of a sleep and
+    /// wakeup when notifications arrive quickly.
+    ///
+    /// A notifier touches the flare no more once the waiter it
+    /// wakes can return, so the waiter may destroy the flare,
+    /// or the object holding it, right after wait returns.
+    ///
     ////////////////////////////////////////////////////////////
     class Flare
     {
@@ -45,9 +58,11 @@ namespace ttl
         ///
         /// \param skip_on_first_wait will skip the first wait()
         /// if true. This value is normally false.
+        /// \param spin_count The amount of times wait() checks for
+        /// a notification before it goes to sleep.
         ///
         ////////////////////////////////////////////////////////////
-        Flare(bool skip_on_first_wait = false);
+        Flare(bool skip_on_first_wait = false, const Sti_t spin_count = 0);
 
         ////////////////////////////////////////////////////////////
         /// \brief Flare's destructor.
@@ -95,11 +110,60 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         void wait();
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Wait until the next notification, or a timeout.
+        ///
+        /// Like wait, but gives up once timeout has passed. The
+        /// spinning counts towards the timeout only loosely.
+        ///
+        /// \return false if the timeout passed without a notification
+        ///
+        ////////////////////////////////////////////////////////////
+        bool waitFor(const std::chrono::nanoseconds timeout);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the spin budget of wait()
+        ///
+        /// wait() checks for a notification spin_count times,
+        /// pausing the cpu in between, before it goes to sleep.
+        /// 0 makes wait() go to sleep at once. Spinning trades cpu
+        /// time for wakeup latency; it only pays off when the
+        /// waiting thread has a core to itself.
+        ///
+        /// \param spin_count The amount of checks before sleeping
+        ///
+        ////////////////////////////////////////////////////////////
+        void setSpinCount(const Sti_t spin_count);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the spin budget of wait()
+        ///
+        /// \return The amount of checks before sleeping
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getSpinCount() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the name shown in the contention report
+        ///
+        /// Does nothing unless TTL_CONTENTION is defined. Every
+        /// wait counts as a write, its wait time included.
+        ///
+        ////////////////////////////////////////////////////////////
+        void setName(const std::string &name);
+
     private:
 
+        bool consume();
+        bool consumeLocked();
+        template <typename CONDITION_VARIABLE_NOTIFY>
+        void publish(CONDITION_VARIABLE_NOTIFY notify);
+
         std::mutex m_mx; ///< Used in the unique_lock
         std::condition_variable m_cndvar; ///< The actual condition variable
-        bool m_notifications : 1; ///< Anti-spurious wakeup boolean and waiting state
+        std::atomic<Sti_t> m_state; ///< The pending notification in the low bits, above them the threads sleeping on m_cndvar
+        std::atomic<Sti_t> m_spin_count; ///< Checks for a notification before sleeping
+        TTL_CONTENTION_SCOPE(Contention m_contention {"Flare"};) ///< Counts waits and notifications
     };
 
 } // Namespace ttl
@@ -163,4 +227,12 @@ namespace ttl
 ///
 /// \endcode
 ///
+/// When both threads have a core of their own, the above
+/// ping-pong becomes a lot faster if the flares spin before
+/// sleeping:
+///
+/// \code
+/// Flare consume(false, 10000), produce(false, 10000);
+/// \endcode
+///
 ////////////////////////////////////////////////////////////
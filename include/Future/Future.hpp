@@ -0,0 +1,352 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef FUTURE_HPP_INCLUDED
+#define FUTURE_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <TTL/Flare/Flare.hpp>
+#include <TTL/Job/Job.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    template <typename T>
+    class Promise;
+
+    ////////////////////////////////////////////////////////////
+    /// \brief The result of work running on another thread
+    ///
+    /// Unlike std::future, the result is stored inside the
+    /// future itself, so nothing is allocated. The future is
+    /// declared by the caller and can neither be copied nor
+    /// moved, since the producing thread writes straight into
+    /// it. A future may be reused once it is ready.
+    ///
+    /// T may be void.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class Future
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// Constructs a future that is not waiting for anything.
+        ///
+        ////////////////////////////////////////////////////////////
+        Future()
+        :
+            m_state(EMPTY)
+        {}
+
+        Future(const Future &) = delete;
+        Future &operator=(const Future &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        /// Waits for the result if it has not yet arrived.
+        ///
+        ////////////////////////////////////////////////////////////
+        ~Future()
+        {
+            this->reset();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Prepare the future for a new result
+        ///
+        /// Waits for and discards any previous result.
+        ///
+        /// \return The promise through which the result is set
+        ///
+        ////////////////////////////////////////////////////////////
+        Promise<T> getPromise()
+        {
+            this->reset();
+            m_state = PENDING;
+            return Promise<T>(*this);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if the result has arrived
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isReady() const
+        {
+            return m_state.load(std::memory_order_acquire) >= FULFILLED;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Block until the result has arrived
+        ///
+        /// Returns at once if the future is not waiting for
+        /// anything.
+        ///
+        ////////////////////////////////////////////////////////////
+        void wait()
+        {
+            const Sti_t state = m_state.load(std::memory_order_acquire);
+            if (state == EMPTY || state == READY)
+            {
+                return;
+            }
+            m_fulfilled.wait(); // The producer's last access, so it is done once this returns
+            m_state.store(READY, std::memory_order_relaxed);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Wait for the result and return it
+        ///
+        /// The future must have been given to issueWork, or have
+        /// handed out a promise.
+        ///
+        ////////////////////////////////////////////////////////////
+        typename std::add_lvalue_reference<T>::type get()
+        {
+            this->wait();
+            return m_slot.get();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Run a function on the result once it arrives
+        ///
+        /// The continuation runs on the thread that sets the
+        /// result, or at once on the calling thread if the result
+        /// has already arrived. It receives a reference to the
+        /// result, or no argument if T is void. A future holds
+        /// one continuation; it must fit in a Job. The future
+        /// must have handed out a promise.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename FUNCTION>
+        void then(FUNCTION continuation)
+        {
+            m_continuation = [this, continuation]() mutable {m_slot.apply(continuation);};
+            Sti_t expected = PENDING;
+            if (m_state.compare_exchange_strong(expected, CONTINUED) == false)
+            {
+                m_continuation();
+                m_continuation = nullptr;
+            }
+        }
+
+    private:
+
+        friend class Promise<T>;
+
+        enum : Sti_t
+        {
+            EMPTY, ///< Not waiting for a result
+            PENDING, ///< Waiting for a result
+            CONTINUED, ///< Waiting for a result, with a continuation
+            FULFILLED, ///< The result is set, and not yet waited for
+            READY ///< The result is set, and the producer is done
+        };
+
+        ////////////////////////////////////////////////////////////
+        template <typename U, typename = void>
+        struct Slot
+        {
+            template <typename... ARGUMENTS>
+            void construct(ARGUMENTS &&...arguments)
+            {
+                new (&storage) U(std::forward<ARGUMENTS>(arguments)...);
+            }
+
+            void destroy()
+            {
+                get().~U();
+            }
+
+            U &get()
+            {
+                return *reinterpret_cast<U *>(&storage);
+            }
+
+            template <typename FUNCTION>
+            void apply(FUNCTION &function)
+            {
+                function(get());
+            }
+
+            typename std::aligned_storage<sizeof(U), alignof(U)>::type storage;
+        };
+
+        ////////////////////////////////////////////////////////////
+        template <typename U>
+        struct Slot<U, typename std::enable_if<std::is_void<U>::value>::type>
+        {
+            void construct() {}
+            void destroy() {}
+            void get() {}
+
+            template <typename FUNCTION>
+            void apply(FUNCTION &function)
+            {
+                function();
+            }
+        };
+
+        ////////////////////////////////////////////////////////////
+        template <typename... ARGUMENTS>
+        void fulfil(ARGUMENTS &&...arguments)
+        {
+            m_slot.construct(std::forward<ARGUMENTS>(arguments)...);
+            if (m_state.exchange(FULFILLED) == CONTINUED)
+            {
+                m_continuation();
+                m_continuation = nullptr;
+            }
+            m_fulfilled.notify(); // Last access, the future may be gone after this
+        }
+
+        ////////////////////////////////////////////////////////////
+        void reset()
+        {
+            if (m_state != EMPTY)
+            {
+                this->wait();
+                m_slot.destroy();
+                m_state = EMPTY;
+            }
+        }
+
+        std::atomic<Sti_t> m_state; ///< One of EMPTY, PENDING, CONTINUED, FULFILLED, READY
+        Slot<T> m_slot; ///< Storage for the result
+        Job m_continuation; ///< Runs when the result is set, if given
+        ttl::Flare m_fulfilled; ///< Notified when the result is set
+
+    };
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Sets the result of a future
+    ///
+    /// A promise is just a reference to its future, and is
+    /// cheap to copy. The result must be set exactly once.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class Promise
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit Promise(Future<T> &future)
+        :
+            m_future(&future)
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the result, which wakes up waiters
+        ///
+        /// Takes no argument if T is void.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename... ARGUMENTS>
+        void setValue(ARGUMENTS &&...arguments)
+        {
+            m_future->fulfil(std::forward<ARGUMENTS>(arguments)...);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the result to the return value of function
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename FUNCTION>
+        void setValueFrom(FUNCTION &function)
+        {
+            this->setValueFrom(function, std::is_void<T>());
+        }
+
+    private:
+
+        ////////////////////////////////////////////////////////////
+        template <typename FUNCTION>
+        void setValueFrom(FUNCTION &function, std::false_type)
+        {
+            m_future->fulfil(function());
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <typename FUNCTION>
+        void setValueFrom(FUNCTION &function, std::true_type)
+        {
+            function();
+            m_future->fulfil();
+        }
+
+        Future<T> *m_future; ///< The future that receives the result
+
+    };
+
+} // Namespace ttl
+
+#endif // FUTURE_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class Future
+///
+/// Getting a result back from a worker:
+///
+/// \code
+/// ttl::Worker worker;
+/// ttl::Future<int> answer;
+/// worker.issueWork(answer, []{return 6 * 7;});
+/// // Do something else in the meantime
+/// std::cout << answer.get() << std::endl;
+/// \endcode
+///
+/// Chaining stages without blocking any thread:
+///
+/// \code
+/// ttl::BatchWorker pool(4);
+/// ttl::Future<std::vector<int>> parsed;
+/// ttl::Future<void> indexed;
+/// pool.issueWork(parsed, [&]{return parse(input);});
+/// parsed.then
+/// (
+///     [&](std::vector<int> &records)
+///     {
+///         pool.issueWork(indexed, [&]{buildIndex(records);});
+///     }
+/// );
+/// // ...
+/// parsed.wait(); // Returns after the continuation has run
+/// indexed.wait();
+/// \endcode
+///
+/// A future must outlive the work it was given to, so a
+/// future that goes out of scope waits for its result.
+///
+////////////////////////////////////////////////////////////
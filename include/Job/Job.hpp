@@ -0,0 +1,240 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef JOB_HPP_INCLUDED
+#define JOB_HPP_INCLUDED
+
+// Headers
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief A move-only void() callable stored inline
+    ///
+    /// Works like std::function<void()>, except that the
+    /// callable is always stored inside the object itself.
+    /// Constructing, moving and calling a job never allocates.
+    /// A callable that does not fit is a compile-time error.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <Sti_t CAPACITY>
+    class BasicJob
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// Constructs an empty job.
+        ///
+        ////////////////////////////////////////////////////////////
+        BasicJob()
+        :
+            m_invoke(nullptr),
+            m_manage(nullptr)
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// Constructs an empty job.
+        ///
+        ////////////////////////////////////////////////////////////
+        BasicJob(std::nullptr_t)
+        :
+            BasicJob()
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param function The callable to store
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename FUNCTION, typename = typename std::enable_if<!std::is_same<typename std::decay<FUNCTION>::type, BasicJob>::value>::type>
+        BasicJob(FUNCTION &&function)
+        {
+            typedef typename std::decay<FUNCTION>::type Callable;
+            static_assert(sizeof(Callable) <= CAPACITY, "The callable is too large to be stored in a job, capture less or capture by reference.");
+            static_assert(alignof(Callable) <= alignof(Storage), "The callable is over-aligned for a job.");
+            new (&m_storage) Callable(std::forward<FUNCTION>(function));
+            m_invoke = &invoke<Callable>;
+            m_manage = &manage<Callable>;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Move ctor
+        ///
+        /// Leaves the other job empty.
+        ///
+        ////////////////////////////////////////////////////////////
+        BasicJob(BasicJob &&job) noexcept
+        :
+            BasicJob()
+        {
+            moveFrom(job);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Move assignment
+        ///
+        /// Leaves the other job empty.
+        ///
+        /// \return A reference to itself
+        ///
+        ////////////////////////////////////////////////////////////
+        BasicJob &operator=(BasicJob &&job) noexcept
+        {
+            if (this != &job)
+            {
+                reset();
+                moveFrom(job);
+            }
+            return *this;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Empties the job
+        ///
+        /// \return A reference to itself
+        ///
+        ////////////////////////////////////////////////////////////
+        BasicJob &operator=(std::nullptr_t)
+        {
+            reset();
+            return *this;
+        }
+
+        BasicJob(const BasicJob &) = delete;
+        BasicJob &operator=(const BasicJob &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        /// Destroys the stored callable.
+        ///
+        ////////////////////////////////////////////////////////////
+        ~BasicJob()
+        {
+            reset();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Calls the stored callable
+        ///
+        /// The job must not be empty.
+        ///
+        ////////////////////////////////////////////////////////////
+        void operator()()
+        {
+            m_invoke(&m_storage);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if a callable is stored
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit operator bool() const
+        {
+            return m_invoke != nullptr;
+        }
+
+    private:
+
+        typedef typename std::aligned_storage<CAPACITY, alignof(std::max_align_t)>::type Storage;
+
+        ////////////////////////////////////////////////////////////
+        template <typename Callable>
+        static void invoke(void *storage)
+        {
+            (*static_cast<Callable *>(storage))();
+        }
+
+        ////////////////////////////////////////////////////////////
+        template <typename Callable>
+        static void manage(void *source, void *destination)
+        {
+            Callable *callable = static_cast<Callable *>(source);
+            if (destination)
+            {
+                new (destination) Callable(std::move(*callable));
+            }
+            callable->~Callable();
+        }
+
+        ////////////////////////////////////////////////////////////
+        void moveFrom(BasicJob &job)
+        {
+            if (job.m_manage)
+            {
+                job.m_manage(&job.m_storage, &m_storage);
+                m_invoke = job.m_invoke;
+                m_manage = job.m_manage;
+                job.m_invoke = nullptr;
+                job.m_manage = nullptr;
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        void reset()
+        {
+            if (m_manage)
+            {
+                m_manage(&m_storage, nullptr);
+                m_invoke = nullptr;
+                m_manage = nullptr;
+            }
+        }
+
+        Storage m_storage; ///< The stored callable
+        void (*m_invoke)(void *); ///< Calls the stored callable
+        void (*m_manage)(void *, void *); ///< Moves and destroys the stored callable
+
+    };
+
+    typedef BasicJob<64> Job; ///< The job type used by Worker and BatchWorker
+
+} // Namespace ttl
+
+#endif // JOB_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class BasicJob
+/// \ingroup Thread Utilities
+///
+/// \code
+/// std::vector<int> v(100);
+/// ttl::Job job([&v](){v[3] = 1;}); // Stored inline, no allocation
+/// ttl::Job other(std::move(job)); // job is now empty
+/// other();
+///
+/// struct {char data[100]; void operator()(){}} huge;
+/// ttl::Job too_large(huge); // Does not compile, use BasicJob<128>
+/// \endcode
+///
+////////////////////////////////////////////////////////////
@@ -54,6 +54,28 @@ namespace ttl
 //        template <typename ...Args>
 //        JoinThread(Args &&...args):std::thread(std::forward<Args>(args)...){}
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// No thread is started.
+        ///
+        ////////////////////////////////////////////////////////////
+        JoinThread() = default;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Move ctor
+        ///
+        ////////////////////////////////////////////////////////////
+        JoinThread(JoinThread &&thread) = default;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Move assignment
+        ///
+        /// Joins the current thread first
+        ///
+        ////////////////////////////////////////////////////////////
+        JoinThread &operator=(JoinThread &&thread);
+
         ////////////////////////////////////////////////////////////
         /// \brief Destructor
         ///
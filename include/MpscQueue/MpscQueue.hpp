@@ -0,0 +1,206 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MPSCQUEUE_HPP_INCLUDED
+#define MPSCQUEUE_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <TTL/Padded/Padded.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Bounded lock-free multi-producer single-consumer queue
+    ///
+    /// Any amount of threads may push simultaneously, but only
+    /// a single thread may pop. Every slot carries a sequence
+    /// number that tells producers and the consumer whether
+    /// the slot is free or filled, so no locks are taken.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class MpscQueue
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param capacity The amount of elements the queue can
+        /// hold, rounded up to a power of two.
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit MpscQueue(const Sti_t capacity = 1024)
+        :
+            m_mask(roundUp(capacity) - 1),
+            m_cells(new Cell[m_mask + 1]),
+            m_head(0),
+            m_tail(0)
+        {
+            for (Sti_t i(0); i <= m_mask; ++i)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue &operator=(const MpscQueue &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add an element to the queue
+        ///
+        /// Safe to call from any thread.
+        ///
+        /// \param value The element to move into the queue
+        /// \return false if the queue is full, value is then left
+        /// untouched.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename U>
+        bool push(U &&value)
+        {
+            Sti_t position = m_tail->load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell &cell = m_cells[position & m_mask];
+                const Sti_t sequence = cell.sequence.load(std::memory_order_acquire);
+                if (sequence == position)
+                {
+                    if (m_tail->compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = std::forward<U>(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (static_cast<std::ptrdiff_t>(sequence - position) < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_tail->load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Remove the oldest element from the queue
+        ///
+        /// Must only be called from the consumer thread.
+        ///
+        /// \param value Receives the element
+        /// \return false if the queue was empty
+        ///
+        ////////////////////////////////////////////////////////////
+        bool pop(T &value)
+        {
+            const Sti_t position = *m_head;
+            Cell &cell = m_cells[position & m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                return false;
+            }
+            value = std::move(cell.value);
+            cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+            *m_head = position + 1;
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if there is nothing to pop
+        ///
+        /// Must only be called from the consumer thread.
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isEmpty() const
+        {
+            const Sti_t position = *m_head;
+            return m_cells[position & m_mask].sequence.load(std::memory_order_acquire) != position + 1;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of elements the queue can hold
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getCapacity() const
+        {
+            return m_mask + 1;
+        }
+
+    private:
+
+        ////////////////////////////////////////////////////////////
+        struct Cell
+        {
+            std::atomic<Sti_t> sequence; ///< Equals the position when free, position + 1 when filled
+            T value;
+        };
+
+        ////////////////////////////////////////////////////////////
+        static Sti_t roundUp(const Sti_t capacity)
+        {
+            Sti_t power(1);
+            while (power < capacity)
+            {
+                power <<= 1;
+            }
+            return power;
+        }
+
+        const Sti_t m_mask; ///< Capacity - 1
+        std::unique_ptr<Cell[]> m_cells; ///< The ring of slots
+        Padded<Sti_t> m_head; ///< Next position to pop, only touched by the consumer
+        Padded<std::atomic<Sti_t>> m_tail; ///< Next position to push
+
+    };
+
+} // Namespace ttl
+
+#endif // MPSCQUEUE_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class MpscQueue
+/// \ingroup Thread Utilities
+///
+/// \code
+/// ttl::MpscQueue<int> queue(256);
+///
+/// // From any amount of producer threads:
+/// while (queue.push(5) == false)
+///     std::this_thread::yield(); // Full, try again later
+///
+/// // From the single consumer thread:
+/// int value;
+/// while (queue.pop(value))
+///     std::cout << value << std::endl;
+/// \endcode
+///
+/// This is the queue every ttl::Worker takes its work from.
+///
+////////////////////////////////////////////////////////////
@@ -0,0 +1,126 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PADDED_HPP_INCLUDED
+#define PADDED_HPP_INCLUDED
+
+// Headers
+#include <utility>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief A value that occupies its own cache line(s)
+    ///
+    /// Used to keep per-thread data in arrays from sharing
+    /// cache lines with its neighbours (false sharing).
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class alignas(cache_line_size) Padded
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param args Forwards the arguments to the constructor
+        /// of the padded value.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ...Args>
+        Padded(Args &&...args)
+        :
+            m_value(std::forward<Args>(args)...)
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Data extraction
+        ///
+        /// \return A reference to the value.
+        ///
+        ////////////////////////////////////////////////////////////
+        T &operator*()
+        {
+            return m_value;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Data extraction
+        ///
+        /// \return A const reference to the value.
+        ///
+        ////////////////////////////////////////////////////////////
+        const T &operator*() const
+        {
+            return m_value;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Data extraction
+        ///
+        /// \return A pointer to the value.
+        ///
+        ////////////////////////////////////////////////////////////
+        T *operator->()
+        {
+            return &m_value;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Data extraction
+        ///
+        /// \return A const pointer to the value.
+        ///
+        ////////////////////////////////////////////////////////////
+        const T *operator->() const
+        {
+            return &m_value;
+        }
+
+    private:
+
+        T m_value; ///< The padded value
+
+    };
+
+} // Namespace ttl
+
+#endif // PADDED_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class Padded
+/// \ingroup Thread Utilities
+///
+/// \code
+/// // Each counter lives on its own cache line, so threads
+/// // incrementing their own counter do not slow each other down.
+/// std::vector<ttl::Padded<std::atomic<int>>> counters(8);
+/// (*counters[3])++;
+/// \endcode
+///
+/// Dynamically allocated arrays of Padded values are only
+/// guaranteed to be aligned since C++17.
+///
+////////////////////////////////////////////////////////////
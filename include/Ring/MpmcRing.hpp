@@ -0,0 +1,367 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef MPMCRING_HPP_INCLUDED
+#define MPMCRING_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <TTL/Padded/Padded.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+#include "RingSignal.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Bounded lock-free multi-producer multi-consumer ring
+    ///
+    /// Works like MpscQueue, except that consumers also claim
+    /// their positions with a compare and exchange. pushN and
+    /// popN claim a whole run of slots with a single compare and
+    /// exchange. A thread that stalls between claiming and
+    /// filling (or emptying) a slot only holds up that slot.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class MpmcRing
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param capacity The amount of elements the ring can
+        /// hold, rounded up to a power of two, at least 2.
+        /// \param blocking true to let waitPush and waitPop sleep
+        /// on a Flare, at the cost of a fence per push and pop.
+        /// They yield otherwise.
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit MpmcRing(const Sti_t capacity = 1024, const bool blocking = false)
+        :
+            m_mask(roundUp(capacity) - 1),
+            m_cells(new Cell[m_mask + 1]),
+            m_head(0),
+            m_tail(0),
+            m_readable(blocking),
+            m_writable(blocking)
+        {
+            for (Sti_t i(0); i <= m_mask; ++i)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpmcRing(const MpmcRing &) = delete;
+        MpmcRing &operator=(const MpmcRing &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add an element to the ring
+        ///
+        /// Safe to call from any thread.
+        ///
+        /// \param value The element to move into the ring
+        /// \return false if the ring is full, value is then left
+        /// untouched.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename U>
+        bool push(U &&value)
+        {
+            Sti_t count = 1;
+            const Sti_t position = this->claim(*m_tail, 0, count);
+            if (position == none)
+            {
+                return false;
+            }
+            Cell &cell = m_cells[position & m_mask];
+            cell.value = std::forward<U>(value);
+            cell.sequence.store(position + 1, std::memory_order_release);
+            m_readable.notify();
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add as many elements of a range as fit
+        ///
+        /// Safe to call from any thread. The pushed elements
+        /// occupy consecutive positions.
+        ///
+        /// \return The amount of elements pushed, always a prefix
+        /// of the range
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        Sti_t pushN(ITERATOR begin, ITERATOR end)
+        {
+            Sti_t count = static_cast<Sti_t>(std::distance(begin, end));
+            if (count == 0)
+            {
+                return 0;
+            }
+            const Sti_t position = this->claim(*m_tail, 0, count);
+            if (position == none)
+            {
+                return 0;
+            }
+            for (Sti_t i = 0; i < count; ++i, ++begin)
+            {
+                Cell &cell = m_cells[(position + i) & m_mask];
+                cell.value = *begin;
+                cell.sequence.store(position + i + 1, std::memory_order_release);
+            }
+            m_readable.notify();
+            return count;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Remove the oldest element from the ring
+        ///
+        /// Safe to call from any thread.
+        ///
+        /// \param value Receives the element
+        /// \return false if the ring was empty
+        ///
+        ////////////////////////////////////////////////////////////
+        bool pop(T &value)
+        {
+            Sti_t count = 1;
+            const Sti_t position = this->claim(*m_head, 1, count);
+            if (position == none)
+            {
+                return false;
+            }
+            Cell &cell = m_cells[position & m_mask];
+            value = std::move(cell.value);
+            cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+            m_writable.notify();
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Remove up to count of the oldest elements
+        ///
+        /// Safe to call from any thread.
+        ///
+        /// \param out Receives the elements, oldest first
+        /// \param count The most elements to pop
+        /// \return The amount of elements popped
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        Sti_t popN(ITERATOR out, Sti_t count)
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+            const Sti_t position = this->claim(*m_head, 1, count);
+            if (position == none)
+            {
+                return 0;
+            }
+            for (Sti_t i = 0; i < count; ++i, ++out)
+            {
+                Cell &cell = m_cells[(position + i) & m_mask];
+                *out = std::move(cell.value);
+                cell.sequence.store(position + i + m_mask + 1, std::memory_order_release);
+            }
+            m_writable.notify();
+            return count;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Push, waiting for room if the ring is full
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename U>
+        void waitPush(U &&value)
+        {
+            m_writable.wait([this, &value]() -> bool {return this->push(std::forward<U>(value));});
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Push a whole range, waiting for room as needed
+        ///
+        /// Elements of other producers may end up in between.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        void waitPushN(ITERATOR begin, ITERATOR end)
+        {
+            while (begin != end)
+            {
+                m_writable.wait
+                (
+                    [this, &begin, end]() -> bool
+                    {
+                        const Sti_t pushed = this->pushN(begin, end);
+                        std::advance(begin, pushed);
+                        return pushed != 0;
+                    }
+                );
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Pop, waiting for an element if the ring is empty
+        ///
+        ////////////////////////////////////////////////////////////
+        void waitPop(T &value)
+        {
+            m_readable.wait([this, &value]() -> bool {return this->pop(value);});
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Pop up to count elements, waiting for at least one
+        ///
+        /// \return The amount of elements popped, at least 1 if
+        /// count is not 0
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        Sti_t waitPopN(ITERATOR out, const Sti_t count)
+        {
+            Sti_t popped = 0;
+            if (count != 0)
+            {
+                m_readable.wait([this, &popped, out, count]() -> bool {return (popped = this->popN(out, count)) != 0;});
+            }
+            return popped;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if there is nothing to pop
+        ///
+        /// Only a hint while other threads push or pop.
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isEmpty() const
+        {
+            const Sti_t position = m_head->load(std::memory_order_relaxed);
+            return m_cells[position & m_mask].sequence.load(std::memory_order_acquire) != position + 1;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of elements the ring can hold
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getCapacity() const
+        {
+            return m_mask + 1;
+        }
+
+    private:
+
+        ////////////////////////////////////////////////////////////
+        struct Cell
+        {
+            std::atomic<Sti_t> sequence; ///< position when free, position + 1 when filled, for the lap it is in
+            T value;
+        };
+
+        static constexpr Sti_t none = ~Sti_t(0); ///< Returned by claim when nothing could be claimed
+
+        ////////////////////////////////////////////////////////////
+        /// Claims up to count consecutive positions from cursor
+        /// whose cells are ready, that is whose sequence is the
+        /// position plus offset (0 for pushing, 1 for popping).
+        /// Lowers count to the amount claimed.
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t claim(std::atomic<Sti_t> &cursor, const Sti_t offset, Sti_t &count)
+        {
+            Sti_t position = cursor.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                const Sti_t sequence = m_cells[position & m_mask].sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t lag = static_cast<std::ptrdiff_t>(sequence - (position + offset));
+                if (lag < 0)
+                {
+                    return none; // Full (or empty): the cell is a lap behind
+                }
+                else if (lag > 0)
+                {
+                    position = cursor.load(std::memory_order_relaxed); // Someone claimed it already
+                    continue;
+                }
+                Sti_t ready = 1;
+                while (ready < count && m_cells[(position + ready) & m_mask].sequence.load(std::memory_order_acquire) == position + ready + offset)
+                {
+                    ++ready;
+                }
+                if (cursor.compare_exchange_weak(position, position + ready, std::memory_order_relaxed))
+                {
+                    count = ready;
+                    return position;
+                }
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        static Sti_t roundUp(const Sti_t capacity)
+        {
+            Sti_t power(2);
+            while (power < capacity)
+            {
+                power <<= 1;
+            }
+            return power;
+        }
+
+        const Sti_t m_mask; ///< Capacity - 1
+        std::unique_ptr<Cell[]> m_cells; ///< The ring of slots
+        Padded<std::atomic<Sti_t>> m_head; ///< Next position to pop
+        Padded<std::atomic<Sti_t>> m_tail; ///< Next position to push
+        RingSignal m_readable; ///< Wakes consumers waiting for elements
+        RingSignal m_writable; ///< Wakes producers waiting for room
+
+    };
+
+} // Namespace ttl
+
+#endif // MPMCRING_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class MpmcRing
+/// \ingroup Thread Utilities
+///
+/// \code
+/// ttl::MpmcRing<Record> ring(4096, true);
+///
+/// // Any amount of producer threads
+/// ring.waitPush(record);
+///
+/// // Any amount of consumer threads
+/// Record records[64];
+/// ttl::Sti_t count = ring.waitPopN(records, 64);
+/// \endcode
+///
+/// \see SpscRing for the cheaper single producer, single
+/// consumer case.
+///
+////////////////////////////////////////////////////////////
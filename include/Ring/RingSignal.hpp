@@ -0,0 +1,137 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef RINGSIGNAL_HPP_INCLUDED
+#define RINGSIGNAL_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <thread>
+#include <TTL/Flare/Flare.hpp>
+#include <TTL/Padded/Padded.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Wakes threads waiting for one side of a ring buffer
+    ///
+    /// A ring keeps one signal for "something to pop" and one
+    /// for "room to push". Waiting threads register themselves
+    /// and sleep on a Flare, so the other side only pays for a
+    /// fence and a load when it makes progress. A non-blocking
+    /// signal never sleeps and lets waiting threads yield instead,
+    /// which costs the other side nothing.
+    ///
+    ////////////////////////////////////////////////////////////
+    class RingSignal
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param blocking true to let waiting threads sleep
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit RingSignal(const bool blocking);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Tell waiting threads that progress was made
+        ///
+        /// Must be called after every successful push (or pop)
+        /// that the waiters of this signal may be waiting for.
+        ///
+        ////////////////////////////////////////////////////////////
+        void notify();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Call attempt until it returns true
+        ///
+        /// Sleeps between failed attempts if the signal is
+        /// blocking, yields otherwise.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ATTEMPT>
+        void wait(ATTEMPT attempt)
+        {
+            while (attempt() == false)
+            {
+                if (m_blocking == false)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                m_waiters->fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence in notify
+                if (attempt())
+                {
+                    m_waiters->fetch_sub(1);
+                    return;
+                }
+                m_flare.wait();
+                m_waiters->fetch_sub(1);
+                if (attempt())
+                {
+                    this->notify(); // A single notification may have been meant for several waiters
+                    return;
+                }
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if waiting threads sleep
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isBlocking() const;
+
+    private:
+
+        const bool m_blocking; ///< Sleep instead of yield
+        Padded<std::atomic<Sti_t>> m_waiters; ///< Threads registered to sleep on m_flare
+        Flare m_flare; ///< Notified when progress is made while someone waits
+
+    };
+
+} // Namespace ttl
+
+#endif // RINGSIGNAL_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class RingSignal
+/// \ingroup Thread Utilities
+///
+/// \code
+/// ttl::RingSignal readable(true);
+///
+/// // Consumer
+/// readable.wait([&]() -> bool {return ring.pop(value);});
+///
+/// // Producer
+/// if (ring.push(value))
+///     readable.notify();
+/// \endcode
+///
+/// \see SpscRing, MpmcRing
+///
+////////////////////////////////////////////////////////////
@@ -0,0 +1,326 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SPSCRING_HPP_INCLUDED
+#define SPSCRING_HPP_INCLUDED
+
+// Headers
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <TTL/Padded/Padded.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+#include "RingSignal.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Bounded wait-free single-producer single-consumer ring
+    ///
+    /// One thread pushes and one thread pops. Each side owns its
+    /// position and keeps a cached copy of the other side's, so
+    /// the shared positions are only read when the cached view
+    /// says the ring is full (or empty). pushN and popN move a
+    /// whole batch with a single release store.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class SpscRing
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param capacity The amount of elements the ring can
+        /// hold, rounded up to a power of two.
+        /// \param blocking true to let waitPush and waitPop sleep
+        /// on a Flare, at the cost of a fence per push and pop.
+        /// They yield otherwise.
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit SpscRing(const Sti_t capacity = 1024, const bool blocking = false)
+        :
+            m_mask(roundUp(capacity) - 1),
+            m_slots(new T[m_mask + 1]),
+            m_head(0),
+            m_tail(0),
+            m_cached_head(0),
+            m_cached_tail(0),
+            m_readable(blocking),
+            m_writable(blocking)
+        {}
+
+        SpscRing(const SpscRing &) = delete;
+        SpscRing &operator=(const SpscRing &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add an element to the ring
+        ///
+        /// Must only be called from the producer thread.
+        ///
+        /// \param value The element to move into the ring
+        /// \return false if the ring is full, value is then left
+        /// untouched.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename U>
+        bool push(U &&value)
+        {
+            const Sti_t tail = m_tail->load(std::memory_order_relaxed);
+            if (this->getRoom(tail, 1) == 0)
+            {
+                return false;
+            }
+            m_slots[tail & m_mask] = std::forward<U>(value);
+            m_tail->store(tail + 1, std::memory_order_release);
+            m_readable.notify();
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add as many elements of a range as fit
+        ///
+        /// Must only be called from the producer thread.
+        ///
+        /// \return The amount of elements pushed, always a prefix
+        /// of the range
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        Sti_t pushN(ITERATOR begin, ITERATOR end)
+        {
+            const Sti_t tail = m_tail->load(std::memory_order_relaxed);
+            const Sti_t count = this->getRoom(tail, static_cast<Sti_t>(std::distance(begin, end)));
+            for (Sti_t i = 0; i < count; ++i, ++begin)
+            {
+                m_slots[(tail + i) & m_mask] = *begin;
+            }
+            if (count != 0)
+            {
+                m_tail->store(tail + count, std::memory_order_release);
+                m_readable.notify();
+            }
+            return count;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Remove the oldest element from the ring
+        ///
+        /// Must only be called from the consumer thread.
+        ///
+        /// \param value Receives the element
+        /// \return false if the ring was empty
+        ///
+        ////////////////////////////////////////////////////////////
+        bool pop(T &value)
+        {
+            const Sti_t head = m_head->load(std::memory_order_relaxed);
+            if (this->getFilled(head, 1) == 0)
+            {
+                return false;
+            }
+            value = std::move(m_slots[head & m_mask]);
+            m_head->store(head + 1, std::memory_order_release);
+            m_writable.notify();
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Remove up to count of the oldest elements
+        ///
+        /// Must only be called from the consumer thread.
+        ///
+        /// \param out Receives the elements, oldest first
+        /// \param count The most elements to pop
+        /// \return The amount of elements popped
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        Sti_t popN(ITERATOR out, const Sti_t count)
+        {
+            const Sti_t head = m_head->load(std::memory_order_relaxed);
+            const Sti_t filled = this->getFilled(head, count);
+            for (Sti_t i = 0; i < filled; ++i, ++out)
+            {
+                *out = std::move(m_slots[(head + i) & m_mask]);
+            }
+            if (filled != 0)
+            {
+                m_head->store(head + filled, std::memory_order_release);
+                m_writable.notify();
+            }
+            return filled;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Push, waiting for room if the ring is full
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename U>
+        void waitPush(U &&value)
+        {
+            m_writable.wait([this, &value]() -> bool {return this->push(std::forward<U>(value));});
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Push a whole range, waiting for room as needed
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        void waitPushN(ITERATOR begin, ITERATOR end)
+        {
+            while (begin != end)
+            {
+                m_writable.wait
+                (
+                    [this, &begin, end]() -> bool
+                    {
+                        const Sti_t pushed = this->pushN(begin, end);
+                        std::advance(begin, pushed);
+                        return pushed != 0;
+                    }
+                );
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Pop, waiting for an element if the ring is empty
+        ///
+        ////////////////////////////////////////////////////////////
+        void waitPop(T &value)
+        {
+            m_readable.wait([this, &value]() -> bool {return this->pop(value);});
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Pop up to count elements, waiting for at least one
+        ///
+        /// \return The amount of elements popped, at least 1 if
+        /// count is not 0
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ITERATOR>
+        Sti_t waitPopN(ITERATOR out, const Sti_t count)
+        {
+            Sti_t popped = 0;
+            if (count != 0)
+            {
+                m_readable.wait([this, &popped, out, count]() -> bool {return (popped = this->popN(out, count)) != 0;});
+            }
+            return popped;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if there is nothing to pop
+        ///
+        /// Exact when called from the consumer thread.
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isEmpty() const
+        {
+            return m_head->load(std::memory_order_relaxed) == m_tail->load(std::memory_order_acquire);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of elements the ring can hold
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getCapacity() const
+        {
+            return m_mask + 1;
+        }
+
+    private:
+
+        ////////////////////////////////////////////////////////////
+        Sti_t getRoom(const Sti_t tail, const Sti_t wanted)
+        {
+            Sti_t room = m_mask + 1 - (tail - *m_cached_head);
+            if (room < wanted)
+            {
+                *m_cached_head = m_head->load(std::memory_order_acquire);
+                room = m_mask + 1 - (tail - *m_cached_head);
+            }
+            return std::min(room, wanted);
+        }
+
+        ////////////////////////////////////////////////////////////
+        Sti_t getFilled(const Sti_t head, const Sti_t wanted)
+        {
+            Sti_t filled = *m_cached_tail - head;
+            if (filled < wanted)
+            {
+                *m_cached_tail = m_tail->load(std::memory_order_acquire);
+                filled = *m_cached_tail - head;
+            }
+            return std::min(filled, wanted);
+        }
+
+        ////////////////////////////////////////////////////////////
+        static Sti_t roundUp(const Sti_t capacity)
+        {
+            Sti_t power(1);
+            while (power < capacity)
+            {
+                power <<= 1;
+            }
+            return power;
+        }
+
+        const Sti_t m_mask; ///< Capacity - 1
+        std::unique_ptr<T[]> m_slots; ///< The ring of elements
+        Padded<std::atomic<Sti_t>> m_head; ///< Next position to pop, written by the consumer
+        Padded<std::atomic<Sti_t>> m_tail; ///< Next position to push, written by the producer
+        Padded<Sti_t> m_cached_head; ///< The producer's last view of m_head
+        Padded<Sti_t> m_cached_tail; ///< The consumer's last view of m_tail
+        RingSignal m_readable; ///< Wakes a consumer waiting for elements
+        RingSignal m_writable; ///< Wakes a producer waiting for room
+
+    };
+
+} // Namespace ttl
+
+#endif // SPSCRING_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class SpscRing
+/// \ingroup Thread Utilities
+///
+/// \code
+/// ttl::SpscRing<Record> ring(4096, true);
+///
+/// // Producer thread, hands records over in batches
+/// ring.waitPushN(batch.begin(), batch.end());
+///
+/// // Consumer thread
+/// Record records[64];
+/// ttl::Sti_t count = ring.waitPopN(records, 64);
+/// \endcode
+///
+/// Prefer this over a Synched<std::deque<T>> to pass records
+/// between two pipeline stages: neither side ever takes a lock.
+///
+////////////////////////////////////////////////////////////
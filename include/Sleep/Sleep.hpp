@@ -23,6 +23,9 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 
 // Headers
 #include <TTL/Ttldef/Ttldef.hpp>
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    #include <immintrin.h>
+#endif
 
 
 namespace ttl
@@ -43,6 +46,25 @@ namespace ttl
     ////////////////////////////////////////////////////////////
     extern void usleep(Sti_t usec);
 
+    ////////////////////////////////////////////////////////////
+    /// \brief hint to the cpu that the caller is spin-waiting
+    ///
+    /// Issues a pause (x86) or yield (ARM) instruction, which
+    /// saves power and frees resources for a sibling
+    /// hyper-thread while spinning. Does not give up the
+    /// time slice.
+    ////////////////////////////////////////////////////////////
+    inline void cpuRelax()
+    {
+        #if defined(__i386__) || defined(__x86_64__)
+            __builtin_ia32_pause();
+        #elif defined(__aarch64__) || defined(__arm__)
+            __asm__ __volatile__("yield");
+        #elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+            _mm_pause();
+        #endif
+    }
+
 } // Namespace ttl
 
 #endif // SLEEP_HPP_INCLUDED
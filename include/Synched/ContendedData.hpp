@@ -0,0 +1,122 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#ifndef CONTENDEDDATA_HPP_INCLUDED
+#define CONTENDEDDATA_HPP_INCLUDED
+
+// Headers
+#include <chrono>
+#include <TTL/Contention/Contention.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+#if defined(TTL_CONTENTION)
+
+    ////////////////////////////////////////////////////////////
+    /// \brief A locking policy that counts its own contention
+    ///
+    /// Wraps any locking policy of Synched and records into
+    /// contention how often and how long readers and writers
+    /// waited, and how long writers held the lock.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename POLICY>
+    class ContendedData : public POLICY
+    {
+    public:
+
+        ContendedData()
+        :
+            contention("Synched")
+        {}
+
+        Sti_t lockShared()
+        {
+            const Contention::Clock::time_point start = Contention::Clock::now();
+            const Sti_t token = POLICY::lockShared();
+            contention.addRead(Contention::Clock::now() - start, POLICY::getReaderCount());
+            return token;
+        }
+
+        bool tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout)
+        {
+            const Contention::Clock::time_point start = Contention::Clock::now();
+            if (POLICY::tryLockShared(token, timeout) == false)
+            {
+                contention.addTimeout();
+                return false;
+            }
+            contention.addRead(Contention::Clock::now() - start, POLICY::getReaderCount());
+            return true;
+        }
+
+        void lock()
+        {
+            const Contention::Clock::time_point start = Contention::Clock::now();
+            POLICY::lock();
+            m_acquired = Contention::Clock::now();
+            contention.addWrite(m_acquired - start);
+        }
+
+        bool tryLock(const std::chrono::nanoseconds timeout)
+        {
+            const Contention::Clock::time_point start = Contention::Clock::now();
+            if (POLICY::tryLock(timeout) == false)
+            {
+                contention.addTimeout();
+                return false;
+            }
+            m_acquired = Contention::Clock::now();
+            contention.addWrite(m_acquired - start);
+            return true;
+        }
+
+        void unlock()
+        {
+            contention.addHold(Contention::Clock::now() - m_acquired);
+            POLICY::unlock();
+        }
+
+        Contention contention;
+
+    private:
+
+        Contention::Clock::time_point m_acquired; ///< When the current writer got access
+
+    };
+
+#else
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Without TTL_CONTENTION, the policy itself
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename POLICY>
+    using ContendedData = POLICY;
+
+#endif // TTL_CONTENTION
+
+} // Namespace ttl
+
+#endif // CONTENDEDDATA_HPP_INCLUDED
@@ -0,0 +1,76 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef FAIRDATA_HPP_INCLUDED
+#define FAIRDATA_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Locking policy of Synched that serves in order
+    ///
+    /// Readers and writers are let in in the order they
+    /// arrive. Readers that arrive one after another read
+    /// together, but never overtake a writer that arrived
+    /// before them, so neither side can be starved.
+    ///
+    ////////////////////////////////////////////////////////////
+    class FairData
+    {
+    public:
+
+        FairData();
+
+        Sti_t lockShared();
+        bool tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout);
+        void unlockShared(const Sti_t token);
+        void lock();
+        bool tryLock(const std::chrono::nanoseconds timeout);
+        void unlock();
+        Sti_t getReaderCount() const;
+
+    private:
+
+        void serveNext();
+        void abandon(const Sti_t ticket);
+
+        std::mutex m_mx; ///< Guards all of the state
+        std::condition_variable m_cndvar; ///< Wakes waiting threads when the state changes
+        Sti_t m_next_ticket; ///< The ticket of the next arrival
+        Sti_t m_serving; ///< The ticket that may enter next
+        std::vector<Sti_t> m_abandoned; ///< Tickets of threads that gave up waiting
+        std::atomic<Sti_t> m_readers; ///< Readers currently reading
+        bool m_writer; ///< Whether a writer is writing
+
+    };
+
+} // Namespace ttl
+
+#endif // FAIRDATA_HPP_INCLUDED
@@ -0,0 +1,84 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef READERBIASEDDATA_HPP_INCLUDED
+#define READERBIASEDDATA_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <TTL/Padded/Padded.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Locking policy of Synched for data that is mostly read
+    ///
+    /// Every thread counts itself as a reader in one of as
+    /// many counters as there are hardware threads, each on its
+    /// own cache line, so readers on different cores do not
+    /// touch each other's lines. Writes are expensive: a writer
+    /// waits for every counter to drain, sleeping once a short
+    /// spin has not emptied one.
+    ///
+    ////////////////////////////////////////////////////////////
+    class ReaderBiasedData
+    {
+    public:
+
+        ReaderBiasedData();
+
+        Sti_t lockShared();
+        bool tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout);
+        void unlockShared(const Sti_t token);
+        void lock();
+        bool tryLock(const std::chrono::nanoseconds timeout);
+        void unlock();
+        Sti_t getReaderCount() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief A small number that is unique to the calling thread
+        ///
+        /// Threads are numbered in the order they first ask, and
+        /// pick their reader counter with it.
+        ///
+        ////////////////////////////////////////////////////////////
+        static Sti_t getThreadIndex();
+
+    private:
+
+        const Sti_t m_slots; ///< The amount of reader counters
+        std::unique_ptr<Padded<std::atomic<Sti_t>>[]> m_readers; ///< Readers per counter
+        std::atomic<bool> m_writer; ///< Whether a writer is writing or waiting for readers
+        std::timed_mutex m_writer_mutex; ///< Held by the writer
+        std::mutex m_mx; ///< Guards sleeping on the condition variable
+        std::condition_variable m_cndvar; ///< Wakes readers after a write, and the writer once a counter drains
+
+    };
+
+} // Namespace ttl
+
+#endif // READERBIASEDDATA_HPP_INCLUDED
@@ -0,0 +1,79 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef READERPREFERRINGDATA_HPP_INCLUDED
+#define READERPREFERRINGDATA_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Locking policy of Synched that favours readers
+    ///
+    /// Readers only wait while a writer is writing, never for
+    /// a writer that is waiting. A writer waits until there
+    /// are no readers at all, so a steady stream of readers
+    /// can starve it. Readers enter with a single atomic
+    /// operation when there is no writer.
+    ///
+    ////////////////////////////////////////////////////////////
+    class ReaderPreferringData
+    {
+    public:
+
+        ReaderPreferringData();
+
+        Sti_t lockShared();
+        bool tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout);
+        void unlockShared(const Sti_t token);
+        void lock();
+        bool tryLock(const std::chrono::nanoseconds timeout);
+        void unlock();
+        Sti_t getReaderCount() const;
+
+    private:
+
+        template <typename PREDICATE>
+        void waitUntil(PREDICATE predicate);
+        template <typename PREDICATE>
+        bool waitUntil(PREDICATE predicate, const std::chrono::steady_clock::time_point deadline);
+        void wake();
+
+        std::atomic<Sti_t> m_state; ///< The amount of readers, or writer
+        std::atomic<Sti_t> m_sleepers; ///< Threads sleeping on the condition variable
+        std::mutex m_mx; ///< Guards sleeping on the condition variable
+        std::condition_variable m_cndvar; ///< Wakes sleeping threads when the state changes
+
+        static constexpr Sti_t writer = ~Sti_t(0); ///< State while a writer is writing
+        static constexpr Sti_t spin_count = 100; ///< Checks of the state before sleeping
+
+    };
+
+} // Namespace ttl
+
+#endif // READERPREFERRINGDATA_HPP_INCLUDED
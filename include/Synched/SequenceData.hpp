@@ -0,0 +1,95 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SEQUENCEDATA_HPP_INCLUDED
+#define SEQUENCEDATA_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <mutex>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Locking policy of Synched for small plain values
+    ///
+    /// A sequence lock: the writer makes the sequence odd while
+    /// it writes and even again when done. Readers copy the
+    /// value without writing anything shared, and copy again
+    /// if the sequence changed in the meantime.
+    ///
+    /// Synched<T, SequenceData> is specialised in
+    /// SequenceSynched.hpp.
+    ///
+    ////////////////////////////////////////////////////////////
+    class SequenceData
+    {
+    public:
+
+        SequenceData();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Wait until no writer is writing
+        ///
+        /// \return The sequence to hand to endRead
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t beginRead() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check whether a copy is consistent
+        ///
+        /// \return false if a writer wrote since beginRead
+        ///
+        ////////////////////////////////////////////////////////////
+        bool endRead(const Sti_t sequence) const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Keep other writers out
+        ///
+        ////////////////////////////////////////////////////////////
+        void lock();
+        void unlock();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Make readers retry, while holding the lock
+        ///
+        /// Only the copy into the shared value needs to be between
+        /// beginWrite and endWrite.
+        ///
+        ////////////////////////////////////////////////////////////
+        void beginWrite();
+        void endWrite();
+
+        Sti_t getReaderCount() const;
+
+    private:
+
+        std::atomic<Sti_t> m_sequence; ///< Odd while a writer is writing
+        std::mutex m_writer_mutex; ///< Held by the writer
+
+    };
+
+} // Namespace ttl
+
+#endif // SEQUENCEDATA_HPP_INCLUDED
@@ -0,0 +1,285 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SEQUENCESYNCHED_HPP_INCLUDED
+#define SEQUENCESYNCHED_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "SequenceData.hpp"
+#include "Synched.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Synched for small plain values, read without locking
+    ///
+    /// Readers get a copy of the value instead of a reference,
+    /// made under a sequence lock, so reading never writes to
+    /// memory that other threads use. Writers change a copy
+    /// that is stored when the writer is destroyed.
+    ///
+    /// The value is kept in relaxed atomic words, so readers
+    /// that race with a writer are well-defined and simply
+    /// retry.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class Synched<T, SequenceData>
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Synched<T, SequenceData> requires a trivially copyable T.");
+        static_assert(std::is_default_constructible<T>::value, "Synched<T, SequenceData> requires a default constructible T.");
+
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief The reader object, holding a copy of the value
+        ///
+        ////////////////////////////////////////////////////////////
+        class Reader
+        {
+        public:
+
+            Reader(const T &value) : m_value(value) {}
+
+            const T *operator->() const {return &m_value;}
+            const T &operator*() const {return m_value;}
+
+        private:
+
+            T m_value; ///< Consistent copy of the value
+
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief The writer object
+        ///
+        /// Blocks other writers, but not readers, until it is
+        /// destroyed, and then stores its copy of the value.
+        ///
+        ////////////////////////////////////////////////////////////
+        class Writer
+        {
+        public:
+
+            Writer(Synched &owner)
+            :
+                m_owner(&owner)
+            {
+                m_owner->m_synch.lock();
+                m_value = m_owner->copy(); // No writer can change the words now
+            }
+
+            Writer(Writer &&other)
+            :
+                m_owner(other.m_owner),
+                m_value(other.m_value)
+            {
+                other.m_owner = nullptr;
+            }
+
+            Writer(const Writer &) = delete;
+            Writer &operator=(const Writer &) = delete;
+
+            ~Writer()
+            {
+                if (m_owner != nullptr)
+                {
+                    m_owner->m_synch.beginWrite();
+                    m_owner->store(m_value);
+                    m_owner->m_synch.endWrite();
+                    m_owner->m_synch.unlock();
+                }
+            }
+
+            T *operator->() {return &m_value;}
+            T &operator*() {return m_value;}
+
+        private:
+
+            Synched *m_owner; ///< Stores the value on destruction, nullptr once moved from
+            T m_value; ///< The value being written
+
+        };
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Default ctor
+        ///
+        ////////////////////////////////////////////////////////////
+        Synched()
+        {
+            this->store(T());
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Argument ctor
+        ///
+        /// \param args Initialise the value, with braces so that
+        /// plain structs can be initialised member by member.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ...Args>
+        Synched(Args &&...args)
+        {
+            this->store(T{std::forward<Args>(args)...});
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Copy ctor
+        ///
+        ////////////////////////////////////////////////////////////
+        Synched(const Synched &copy)
+        {
+            this->store(copy.load());
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Copy ctor, chosen over the argument ctor
+        ///
+        ////////////////////////////////////////////////////////////
+        Synched(Synched &copy)
+        :
+            Synched(static_cast<const Synched &>(copy))
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Copy assignment
+        ///
+        ////////////////////////////////////////////////////////////
+        Synched &operator=(const Synched &copy)
+        {
+            *(this->getWriteAccess()) = copy.load();
+            return *this;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief returns a Writer
+        ///
+        ////////////////////////////////////////////////////////////
+        Writer getWriteAccess()
+        {
+            return Writer(*this);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief returns a Reader with a consistent copy
+        ///
+        ////////////////////////////////////////////////////////////
+        const Reader getReadAccess() const
+        {
+            return Reader(this->load());
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get a consistent copy of the value
+        ///
+        ////////////////////////////////////////////////////////////
+        T load() const
+        {
+            Sti_t sequence;
+            T value;
+            do
+            {
+                sequence = m_synch.beginRead();
+                value = this->copy();
+            }
+            while (m_synch.endRead(sequence) == false);
+            return value;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief The count of readers
+        ///
+        /// \return Always 0, readers are not counted.
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getReaderCount() const
+        {
+            return m_synch.getReaderCount();
+        }
+
+    private:
+
+        ////////////////////////////////////////////////////////////
+        T copy() const
+        {
+            std::uint64_t words[word_count];
+            for (Sti_t i = 0; i < word_count; ++i)
+            {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            T value;
+            std::memcpy(&value, words, sizeof(T));
+            return value;
+        }
+
+        ////////////////////////////////////////////////////////////
+        void store(const T &value)
+        {
+            std::uint64_t words[word_count] = {};
+            std::memcpy(words, &value, sizeof(T));
+            for (Sti_t i = 0; i < word_count; ++i)
+            {
+                m_words[i].store(words[i], std::memory_order_relaxed);
+            }
+        }
+
+        static constexpr Sti_t word_count = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        mutable SequenceData m_synch; ///< The sequence lock
+        std::atomic<std::uint64_t> m_words[word_count]; ///< The value, word by word
+
+    };
+
+} // Namespace ttl
+
+#endif // SEQUENCESYNCHED_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class Synched<T, SequenceData>
+/// \ingroup Thread Utilities
+///
+/// \code
+/// struct Position {double x, y, z;};
+/// ttl::Synched<Position, ttl::SequenceData> position(1.0, 2.0, 3.0);
+///
+/// // From many threads, without writing shared memory:
+/// Position p = position.load();
+/// double x = position.getReadAccess()->x;
+///
+/// // From the writer:
+/// {
+///     auto writer = position.getWriteAccess();
+///     writer->x += 1.0;
+///     writer->y += 1.0;
+/// } // Readers see both changes, or neither
+/// \endcode
+///
+/// Reads cost a few loads, and are repeated while a write
+/// is being stored, so keep the value to a few cache lines.
+///
+////////////////////////////////////////////////////////////
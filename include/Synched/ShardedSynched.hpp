@@ -0,0 +1,216 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SHARDEDSYNCHED_HPP_INCLUDED
+#define SHARDEDSYNCHED_HPP_INCLUDED
+
+// Headers
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <TTL/Padded/Padded.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+#include "Synched.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief A map split into independently locked shards
+    ///
+    /// Every key belongs to one shard, found by hashing it, and
+    /// every shard is a Synched map on its own cache lines.
+    /// Threads that use different shards never contend, not
+    /// even when they write.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename MAP, typename POLICY = SynchedData, typename HASH = std::hash<typename MAP::key_type>>
+    class ShardedSynched
+    {
+    public:
+
+        typedef typename MAP::key_type Key; ///< The key type of the map
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// \param shards The amount of shards, rounded up to a
+        /// power of two. 0 makes four shards per hardware thread.
+        ///
+        ////////////////////////////////////////////////////////////
+        ShardedSynched(const Sti_t shards = 0, const HASH &hash = HASH())
+        :
+            m_shift(64),
+            m_hash(hash)
+        {
+            const Sti_t wanted = shards != 0 ? shards : 4 * std::max(1u, std::thread::hardware_concurrency());
+            Sti_t count = 1;
+            while (count < wanted)
+            {
+                count *= 2;
+                --m_shift;
+            }
+            m_shards.reset(new Padded<Synched<MAP, POLICY>>[count]);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief returns a SynchedWriter of the shard of key
+        ///
+        /// Only blocks the readers and writers of that shard.
+        ///
+        ////////////////////////////////////////////////////////////
+        SynchedWriter<MAP, POLICY> getWriteAccess(const Key &key)
+        {
+            return m_shards[this->getShardIndex(key)]->getWriteAccess();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief returns a SynchedReader of the shard of key
+        ///
+        ////////////////////////////////////////////////////////////
+        const SynchedReader<MAP, POLICY> getReadAccess(const Key &key) const
+        {
+            return m_shards[this->getShardIndex(key)]->getReadAccess();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Like getWriteAccess, but gives up after timeout
+        ///
+        ////////////////////////////////////////////////////////////
+        SynchedWriter<MAP, POLICY> tryGetWriteAccess(const Key &key, const std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0))
+        {
+            return m_shards[this->getShardIndex(key)]->tryGetWriteAccess(timeout);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Like getReadAccess, but gives up after timeout
+        ///
+        ////////////////////////////////////////////////////////////
+        const SynchedReader<MAP, POLICY> tryGetReadAccess(const Key &key, const std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0)) const
+        {
+            return m_shards[this->getShardIndex(key)]->tryGetReadAccess(timeout);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of shards
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getShardCount() const
+        {
+            return Sti_t(1) << (64 - m_shift);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the shard that key belongs to
+        ///
+        /// The hash is mixed before it picks a shard, so that
+        /// the keys of one shard still spread over the buckets
+        /// of its map.
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getShardIndex(const Key &key) const
+        {
+            if (m_shift == 64)
+            {
+                return 0;
+            }
+            return static_cast<Sti_t>((static_cast<std::uint64_t>(m_hash(key)) * 0x9E3779B97F4A7C15ull) >> m_shift);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get a shard, to visit every key
+        ///
+        /// Locking every shard in turn does not give a consistent
+        /// view of the whole map.
+        ///
+        ////////////////////////////////////////////////////////////
+        Synched<MAP, POLICY> &getShard(const Sti_t index)
+        {
+            return *m_shards[index];
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get a shard, to visit every key
+        ///
+        ////////////////////////////////////////////////////////////
+        const Synched<MAP, POLICY> &getShard(const Sti_t index) const
+        {
+            return *m_shards[index];
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Name every shard for the contention report
+        ///
+        /// The shards share the name, so the report adds them up.
+        ///
+        ////////////////////////////////////////////////////////////
+        void setName(const std::string &name)
+        {
+            for (Sti_t i = 0; i < this->getShardCount(); ++i)
+            {
+                m_shards[i]->setName(name);
+            }
+        }
+
+    private:
+
+        std::unique_ptr<Padded<Synched<MAP, POLICY>>[]> m_shards; ///< Every shard on its own cache lines
+        unsigned m_shift; ///< 64 minus the bits of a shard index
+        HASH m_hash; ///< Hashes a key
+
+    };
+
+} // Namespace ttl
+
+#endif // SHARDEDSYNCHED_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class ShardedSynched
+/// \ingroup Thread Utilities
+///
+/// \code
+/// ttl::ShardedSynched<std::unordered_map<std::string, int>> hits;
+///
+/// // From many threads at once:
+/// ++(*hits.getWriteAccess("/index"))["/index"];
+///
+/// auto shard = hits.getReadAccess("/about");
+/// auto it = shard->find("/about");
+/// if (it != shard->end()) { ... }
+///
+/// // Everything, shard by shard:
+/// for (std::size_t i = 0; i < hits.getShardCount(); ++i)
+/// {
+///     for (auto &entry : *hits.getShard(i).getReadAccess()) { ... }
+/// }
+/// \endcode
+///
+/// The accessors lock the shard of the key only, so
+/// lookups of different keys mostly proceed in parallel.
+/// Combine with ReaderBiasedData for maps that are mostly
+/// read.
+///
+////////////////////////////////////////////////////////////
@@ -0,0 +1,137 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SNAPSHOTDATA_HPP_INCLUDED
+#define SNAPSHOTDATA_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <memory>
+#include <TTL/Padded/Padded.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Tracks the readers of a SnapshotSynched
+    ///
+    /// Readers count themselves in one of two phases, in one
+    /// of as many counters per phase as there are hardware
+    /// threads. Replaced versions are retired, and deleted once
+    /// new readers have been moved to the other phase and the
+    /// old one has drained, twice, after which no reader that
+    /// could hold them is left. Nobody waits for that: whoever
+    /// finds a phase drained, the writer or the reader that
+    /// left last, moves on and deletes.
+    ///
+    ////////////////////////////////////////////////////////////
+    class SnapshotData
+    {
+    public:
+
+        SnapshotData();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        /// Deletes every retired version. No readers may be left.
+        ///
+        ////////////////////////////////////////////////////////////
+        ~SnapshotData();
+
+        SnapshotData(const SnapshotData &) = delete;
+        SnapshotData &operator=(const SnapshotData &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Count the calling thread as a reader
+        ///
+        /// \return A token that is handed back to leave
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t enter();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Stop counting a reader
+        ///
+        /// May delete retired versions the reader was the last
+        /// to possibly hold.
+        ///
+        ////////////////////////////////////////////////////////////
+        void leave(const Sti_t token);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Delete a version once no reader can hold it
+        ///
+        /// The version must no longer be reachable by new
+        /// readers. Never waits; the version is deleted right
+        /// away if there are no readers, else by the thread that
+        /// sees the last reader that could hold it leave.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename T>
+        void retire(T *version)
+        {
+            this->retire(version, [](void *data) -> void {delete static_cast<T *>(data);});
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of readers
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getReaderCount() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of versions that are not deleted yet
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getRetiredCount() const;
+
+    private:
+
+        struct Retired
+        {
+            void *data;
+            void (*destroy)(void *);
+            Retired *next;
+        };
+
+        void retire(void *data, void (*destroy)(void *));
+        void reclaim();
+        void advance();
+        bool isDrained(const Sti_t phase) const;
+        static Sti_t destroy(Retired *retired);
+
+        const Sti_t m_slots; ///< The amount of counters per phase
+        std::unique_ptr<Padded<std::atomic<Sti_t>>[]> m_readers; ///< Readers per counter, both phases of a counter side by side
+        std::atomic<Sti_t> m_phase; ///< The phase new readers count themselves in
+        std::atomic<Sti_t> m_retired_count; ///< Versions retired and not yet deleted
+        std::atomic<Retired *> m_retired; ///< Versions retired since the grace period in progress began
+        Retired *m_grace; ///< Versions waiting for the grace period in progress, owned by whoever holds m_reclaiming
+        bool m_second_flip; ///< Whether the grace period in progress waits for its second phase
+        std::atomic<bool> m_reclaiming; ///< Held by the thread advancing the grace period
+        std::atomic<bool> m_again; ///< Set when another thread found m_reclaiming held
+
+    };
+
+} // Namespace ttl
+
+#endif // SNAPSHOTDATA_HPP_INCLUDED
@@ -0,0 +1,120 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SNAPSHOTREADER_HPP_INCLUDED
+#define SNAPSHOTREADER_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include "SnapshotData.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief The reader object of SnapshotSynched
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class SnapshotReader
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// Counts itself as a reader, and takes the current
+        /// version. Never waits.
+        ///
+        /// \param synch The readers of the SnapshotSynched
+        /// \param current The current version
+        ///
+        ////////////////////////////////////////////////////////////
+        SnapshotReader(SnapshotData &synch, const std::atomic<T *> &current)
+        :
+            m_synch(&synch),
+            m_token(synch.enter()),
+            m_data(current.load())
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Move constructor
+        ///
+        ////////////////////////////////////////////////////////////
+        SnapshotReader(SnapshotReader &&other)
+        :
+            m_synch(other.m_synch),
+            m_token(other.m_token),
+            m_data(other.m_data)
+        {
+            other.m_synch = nullptr;
+        }
+
+        SnapshotReader(const SnapshotReader &) = delete;
+        SnapshotReader &operator=(const SnapshotReader &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        /// Lets the version be reclaimed once it is replaced.
+        ///
+        ////////////////////////////////////////////////////////////
+        ~SnapshotReader()
+        {
+            if (m_synch != nullptr)
+            {
+                m_synch->leave(m_token);
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Data extraction
+        ///
+        /// \return A const pointer to the data.
+        ///
+        ////////////////////////////////////////////////////////////
+        const T *operator->() const
+        {
+            return m_data;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Data extraction
+        ///
+        /// \return A const reference to the data.
+        ///
+        ////////////////////////////////////////////////////////////
+        const T &operator*() const
+        {
+            return *m_data;
+        }
+
+    private:
+
+        SnapshotData *m_synch; ///< The readers of the SnapshotSynched, nullptr once moved from
+        Sti_t m_token; ///< Handed back to m_synch on destruction
+        const T *m_data; ///< The version taken on construction
+
+    };
+
+} // Namespace ttl
+
+#endif // SNAPSHOTREADER_HPP_INCLUDED
@@ -0,0 +1,161 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SNAPSHOTSYNCHED_HPP_INCLUDED
+#define SNAPSHOTSYNCHED_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include "SnapshotData.hpp"
+#include "SnapshotReader.hpp"
+#include "SnapshotWriter.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Encapsulator whose readers never wait
+    ///
+    /// Like Synched, but a reader takes a snapshot of the data
+    /// without any lock, and a writer changes a copy that
+    /// replaces the data once it is done. Readers keep their
+    /// snapshot for as long as they live; the old version is
+    /// deleted once none of them is left, by the writer or by
+    /// the last of those readers. Neither waits for the other.
+    ///
+    /// Every write copies the data, so this suits data that is
+    /// read far more often than it is written.
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class SnapshotSynched
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Argument ctor
+        ///
+        /// \param args Forwards the arguments to the constructor
+        /// of the data specified in the template.
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename ...Args>
+        SnapshotSynched(Args &&...args)
+        :
+            m_current(new T(std::forward<Args>(args)...))
+        {}
+
+        SnapshotSynched(const SnapshotSynched &) = delete;
+        SnapshotSynched &operator=(const SnapshotSynched &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        /// No readers or writers may be left. Deletes the
+        /// versions still waiting for their readers as well.
+        ///
+        ////////////////////////////////////////////////////////////
+        ~SnapshotSynched()
+        {
+            delete m_current.load();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief returns a SnapshotWriter
+        ///
+        /// Waits for other writers only. The changes become
+        /// visible to new readers when the SnapshotWriter is
+        /// destroyed, which does not wait for the readers of the
+        /// previous version, so a thread may write while it holds
+        /// a SnapshotReader of the same data. It keeps seeing the
+        /// version it took.
+        ///
+        /// \return a SnapshotWriter object
+        ///
+        ////////////////////////////////////////////////////////////
+        SnapshotWriter<T> getWriteAccess()
+        {
+            return SnapshotWriter<T>(m_synch, m_current, m_writer_mutex);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief returns a SnapshotReader
+        ///
+        /// Never waits, not even for a writer.
+        ///
+        /// \return a SnapshotReader object
+        ///
+        ////////////////////////////////////////////////////////////
+        SnapshotReader<T> getReadAccess() const
+        {
+            return SnapshotReader<T>(m_synch, m_current);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief The count of readers
+        ///
+        /// \return the amount of readers currently reading the data.
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getReaderCount() const
+        {
+            return m_synch.getReaderCount();
+        }
+
+    private:
+
+        mutable SnapshotData m_synch; ///< The readers of every version
+        std::atomic<T *> m_current; ///< The version new readers take
+        std::mutex m_writer_mutex; ///< Held by the writer
+
+    };
+
+} // Namespace ttl
+
+#endif // SNAPSHOTSYNCHED_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class SnapshotSynched
+/// \ingroup Thread Utilities
+///
+/// \code
+/// ttl::SnapshotSynched<std::map<std::string, std::string>> routes;
+///
+/// // From many threads, never blocked:
+/// auto table = routes.getReadAccess();
+/// auto it = table->find("/index");
+///
+/// // From thread 2, while the readers keep going:
+/// {
+///     auto table = routes.getWriteAccess();
+///     (*table)["/index"] = "backend-2";
+/// } // Published here
+/// \endcode
+///
+/// Readers count themselves per hardware thread, and an old
+/// version is deleted once every reader that could hold it
+/// has left, like read-copy-update. Whoever sees the last of
+/// them leave deletes it, so neither readers nor writers wait.
+///
+////////////////////////////////////////////////////////////
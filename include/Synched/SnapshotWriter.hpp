@@ -0,0 +1,121 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SNAPSHOTWRITER_HPP_INCLUDED
+#define SNAPSHOTWRITER_HPP_INCLUDED
+
+// Headers
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "SnapshotData.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief The writer object of SnapshotSynched
+    ///
+    ////////////////////////////////////////////////////////////
+    template <typename T>
+    class SnapshotWriter
+    {
+    public:
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        /// Blocks other writers, and copies the current version.
+        /// Readers are not blocked.
+        ///
+        /// \param synch The readers of the SnapshotSynched
+        /// \param current The current version
+        /// \param writer_mutex Held by the writer
+        ///
+        ////////////////////////////////////////////////////////////
+        SnapshotWriter(SnapshotData &synch, std::atomic<T *> &current, std::mutex &writer_mutex)
+        :
+            m_synch(&synch),
+            m_current(&current),
+            m_lock(writer_mutex),
+            m_next(new T(*current.load()))
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Move constructor
+        ///
+        ////////////////////////////////////////////////////////////
+        SnapshotWriter(SnapshotWriter &&other) = default;
+
+        SnapshotWriter(const SnapshotWriter &) = delete;
+        SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Destructor
+        ///
+        /// Publishes the copy, and retires the previous version,
+        /// which is deleted once no reader holds it. Does not
+        /// wait for the readers. Lets the next writer in after
+        /// that.
+        ///
+        ////////////////////////////////////////////////////////////
+        ~SnapshotWriter()
+        {
+            if (m_next != nullptr)
+            {
+                m_synch->retire(m_current->exchange(m_next.release()));
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Data extraction
+        ///
+        /// \return A pointer to the copy.
+        ///
+        ////////////////////////////////////////////////////////////
+        T *operator->() const
+        {
+            return m_next.get();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Data extraction
+        ///
+        /// \return A reference to the copy.
+        ///
+        ////////////////////////////////////////////////////////////
+        T &operator*() const
+        {
+            return *m_next;
+        }
+
+    private:
+
+        SnapshotData *m_synch; ///< The readers of the SnapshotSynched
+        std::atomic<T *> *m_current; ///< The current version
+        std::unique_lock<std::mutex> m_lock; ///< Keeps other writers out
+        std::unique_ptr<T> m_next; ///< The copy that is published on destruction, nullptr once moved from
+
+    };
+
+} // Namespace ttl
+
+#endif // SNAPSHOTWRITER_HPP_INCLUDED
@@ -22,10 +22,15 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 #define SYNCHED_HPP_INCLUDED
 
 // Headers
+#include <chrono>
 #include <mutex>
+#include <string>
 #include "SynchedWriter.hpp"
 #include "SynchedReader.hpp"
 #include "SynchedData.hpp"
+#include "ReaderPreferringData.hpp"
+#include "FairData.hpp"
+#include "ReaderBiasedData.hpp"
 
 
 namespace ttl
@@ -43,8 +48,12 @@ namespace ttl
     /// Another option is to make the mutable a Synched<>
     /// object.
     ///
+    /// POLICY decides who goes first when readers and writers
+    /// meet: SynchedData, ReaderPreferringData, FairData or
+    /// ReaderBiasedData.
+    ///
     ////////////////////////////////////////////////////////////
-    template <typename T>
+    template <typename T, typename POLICY = SynchedData>
     class Synched
     {
     public:
@@ -143,7 +152,7 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         Synched &operator=(Synched &&copy)
         {
-            SynchedWriter<T> wexed = copy.getWriteAccess();
+            SynchedWriter<T, POLICY> wexed = copy.getWriteAccess();
             *(this->getWriteAccess()) = *(wexed);
             *(wexed) = T();
             return *this;
@@ -167,9 +176,25 @@ namespace ttl
         /// \return a SynchedWriter object
         ///
         ////////////////////////////////////////////////////////////
-        SynchedWriter<T> getWriteAccess()
+        SynchedWriter<T, POLICY> getWriteAccess()
+        {
+            return SynchedWriter<T, POLICY>(m_synch, m_data);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief returns a SynchedWriter, unless it takes too long
+        ///
+        /// Like getWriteAccess, but gives up once timeout has
+        /// passed. A timeout of 0 only succeeds if no one is
+        /// reading or writing.
+        ///
+        /// \return a SynchedWriter object that converts to false
+        /// if it did not get access
+        ///
+        ////////////////////////////////////////////////////////////
+        SynchedWriter<T, POLICY> tryGetWriteAccess(const std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0))
         {
-            return SynchedWriter<T>(m_synch, m_data);
+            return SynchedWriter<T, POLICY>(m_synch, m_data, timeout);
         }
 
         ////////////////////////////////////////////////////////////
@@ -181,9 +206,24 @@ namespace ttl
         /// \return a SynchedReader object
         ///
         ////////////////////////////////////////////////////////////
-        const SynchedReader<T> getReadAccess() const
+        const SynchedReader<T, POLICY> getReadAccess() const
+        {
+            return SynchedReader<T, POLICY>(m_synch, m_data);
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief returns a SynchedReader, unless it takes too long
+        ///
+        /// Like getReadAccess, but gives up once timeout has
+        /// passed.
+        ///
+        /// \return a SynchedReader object that converts to false
+        /// if it did not get access
+        ///
+        ////////////////////////////////////////////////////////////
+        const SynchedReader<T, POLICY> tryGetReadAccess(const std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0)) const
         {
-            return SynchedReader<T>(m_synch, m_data);
+            return SynchedReader<T, POLICY>(m_synch, m_data, timeout);
         }
 
         ////////////////////////////////////////////////////////////
@@ -194,12 +234,26 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         Sti_t getReaderCount() const
         {
-            return m_synch.readers.load();
+            return m_synch.getReaderCount();
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set the name shown in the contention report
+        ///
+        /// Does nothing unless TTL_CONTENTION is defined.
+        ///
+        /// \see Contention
+        ///
+        ////////////////////////////////////////////////////////////
+        void setName(const std::string &name)
+        {
+            TTL_CONTENTION_SCOPE(m_synch.contention.setName(name);)
+            static_cast<void>(name);
         }
 
     private:
 
-        mutable SynchedData m_synch; ///< The data used to synchronize
+        mutable ContendedData<POLICY> m_synch; ///< The data used to synchronize
         T m_data; ///< The raw data object
     };
 
@@ -230,4 +284,22 @@ namespace ttl
 /// (*x)++;
 ///
 /// \endcode
+///
+/// Configuration that is read on every request by many
+/// threads, and rarely changed, scales better with a
+/// reader-biased policy, where readers on different cores
+/// count themselves on different cache lines:
+///
+/// \code
+/// ttl::Synched<Config, ttl::ReaderBiasedData> config;
+/// std::string host = config.getReadAccess()->host;
+/// \endcode
+///
+/// When TTL_CONTENTION is defined, every Synched counts its
+/// acquisitions and waits. Name the ones to look at:
+///
+/// \code
+/// config.setName("config");
+/// ttl::Contention::writeReport(std::cerr);
+/// \endcode
 ////////////////////////////////////////////////////////////
@@ -24,6 +24,7 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 // Headers
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <TTL/Flare/Flare.hpp>
 #include <TTL/Ttldef/Ttldef.hpp>
 
@@ -34,13 +35,31 @@ namespace ttl
     ////////////////////////////////////////////////////////////
     /// \brief Wrapper of Synched's internal data
     ///
+    /// The default locking policy of Synched. A writer that is
+    /// waiting holds back new readers, so writers are never
+    /// starved, but every reader passes through one mutex.
+    ///
+    /// A locking policy provides lockShared, unlockShared,
+    /// lock, unlock and getReaderCount. lockShared returns a
+    /// token that is handed back to unlockShared. tryLockShared
+    /// and tryLock give up after a timeout, and return whether
+    /// they got access.
+    ///
     ////////////////////////////////////////////////////////////
     struct SynchedData
     {
         SynchedData();
         ~SynchedData() = default;
 
-        std::mutex  entry_mutex;
+        Sti_t lockShared();
+        bool tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout);
+        void unlockShared(const Sti_t token);
+        void lock();
+        bool tryLock(const std::chrono::nanoseconds timeout);
+        void unlock();
+        Sti_t getReaderCount() const;
+
+        std::timed_mutex  entry_mutex;
         ttl::Flare  writer_activation;
         std::atomic<Sti_t> readers;
     };
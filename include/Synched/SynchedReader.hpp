@@ -22,7 +22,9 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 #define SYNCHEDREADER_HPP_INCLUDED
 
 // Headers
+#include <chrono>
 #include <mutex>
+#include "ContendedData.hpp"
 #include "SynchedData.hpp"
 
 
@@ -33,7 +35,7 @@ namespace ttl
     /// \brief The reader object
     ///
     ////////////////////////////////////////////////////////////
-    template <typename T>
+    template <typename T, typename POLICY = SynchedData>
     class SynchedReader
     {
     public:
@@ -44,20 +46,35 @@ namespace ttl
         /// Takes a reference to the data and Synchronization
         /// primitives of Synched.
         ///
-        /// \param synch The synchronization struct
+        /// \param synch The locking policy
         /// \param data The data to reference
         ///
         ////////////////////////////////////////////////////////////
-        SynchedReader(SynchedData &synch, const T &data)
+        SynchedReader(ContendedData<POLICY> &synch, const T &data)
         :
             m_synch(synch),
-            m_data(data)
-        {
-            m_synch.entry_mutex.lock();
-            m_synch.entry_mutex.unlock();
-            if (m_synch.readers.fetch_add(1) == 0)
-                m_synch.writer_activation.wait();
-        }
+            m_data(data),
+            m_token(synch.lockShared()),
+            m_owns(true)
+        {}
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor that gives up after a timeout
+        ///
+        /// \param synch The locking policy
+        /// \param data The data to reference
+        /// \param timeout How long to wait for writers at most
+        ///
+        /// \see operator bool
+        ///
+        ////////////////////////////////////////////////////////////
+        SynchedReader(ContendedData<POLICY> &synch, const T &data, const std::chrono::nanoseconds timeout)
+        :
+            m_synch(synch),
+            m_data(data),
+            m_token(0),
+            m_owns(synch.tryLockShared(m_token, timeout))
+        {}
 
         ////////////////////////////////////////////////////////////
         /// \brief Destructor
@@ -67,12 +84,24 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         ~SynchedReader()
         {
-            if (m_synch.readers.fetch_sub(1) == 1)
+            if (m_owns)
             {
-                m_synch.writer_activation.notify();
+                m_synch.unlockShared(m_token);
             }
         }
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Whether the data may be read
+        ///
+        /// \return false if the timeout passed before access was
+        /// granted
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit operator bool() const
+        {
+            return m_owns;
+        }
+
         ////////////////////////////////////////////////////////////
         /// \brief Data extraction
         ///
@@ -103,13 +132,15 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         Sti_t getReaderCount() const
         {
-            return m_synch.readers.load();
+            return m_synch.getReaderCount();
         }
 
     private:
 
-        SynchedData &m_synch; ///< The data used to synchronize
+        ContendedData<POLICY> &m_synch; ///< The data used to synchronize
         const T &m_data; ///< The raw data object
+        Sti_t m_token; ///< Handed back to the policy on destruction
+        const bool m_owns; ///< Whether access was granted
 
     };
 
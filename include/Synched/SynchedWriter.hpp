@@ -22,7 +22,9 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 #define SYNCHEDWRITER_HPP_INCLUDED
 
 // Headers
+#include <chrono>
 #include <mutex>
+#include "ContendedData.hpp"
 #include "SynchedData.hpp"
 
 
@@ -33,7 +35,7 @@ namespace ttl
     /// \brief The writer object
     ///
     ////////////////////////////////////////////////////////////
-    template <typename T>
+    template <typename T, typename POLICY = SynchedData>
     class SynchedWriter
     {
     public:
@@ -44,19 +46,37 @@ namespace ttl
         /// Blocks new readers from being created,
         /// waits for all readers to finish.
         ///
-        /// \param synch The synchronization struct
+        /// \param synch The locking policy
         /// \param data The data to reference
         ///
         ////////////////////////////////////////////////////////////
-        SynchedWriter(SynchedData &synch, T &data)
+        SynchedWriter(ContendedData<POLICY> &synch, T &data)
         :
             m_synch(synch),
-            m_data(data)
+            m_data(data),
+            m_owns(true)
         {
-            m_synch.entry_mutex.lock();
-            m_synch.writer_activation.wait();
+            m_synch.lock();
         }
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor that gives up after a timeout
+        ///
+        /// \param synch The locking policy
+        /// \param data The data to reference
+        /// \param timeout How long to wait for readers and
+        /// writers at most
+        ///
+        /// \see operator bool
+        ///
+        ////////////////////////////////////////////////////////////
+        SynchedWriter(ContendedData<POLICY> &synch, T &data, const std::chrono::nanoseconds timeout)
+        :
+            m_synch(synch),
+            m_data(data),
+            m_owns(synch.tryLock(timeout))
+        {}
+
         ////////////////////////////////////////////////////////////
         /// \brief Destructor
         ///
@@ -65,8 +85,22 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         ~SynchedWriter()
         {
-            m_synch.entry_mutex.unlock();
-            m_synch.writer_activation.notify();
+            if (m_owns)
+            {
+                m_synch.unlock();
+            }
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Whether the data may be written
+        ///
+        /// \return false if the timeout passed before access was
+        /// granted
+        ///
+        ////////////////////////////////////////////////////////////
+        explicit operator bool() const
+        {
+            return m_owns;
         }
 
         ////////////////////////////////////////////////////////////
@@ -99,13 +133,14 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         Sti_t getReaderCount() const
         {
-            return m_synch.readers.load();
+            return m_synch.getReaderCount();
         }
 
     private:
 
-        SynchedData &m_synch; ///< The data used to synchronize
+        ContendedData<POLICY> &m_synch; ///< The data used to synchronize
         T &m_data; ///< The raw data object
+        const bool m_owns; ///< Whether access was granted
 
     };
 
@@ -22,18 +22,27 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 #define TTL_HPP_INCLUDED
 
     #include "Argument/Argument.hpp"
+    #include "Barrier/Barrier.hpp"
     #include "BatchWorker/BatchWorker.hpp"
     #include "Benchmark/Benchmark.hpp"
     #include "Bool/Bool.hpp"
+    #include "Contention/Contention.hpp"
+    #include "Coroutine/Coroutine.hpp"
     #include "Debug/Debug.hpp"
     #include "File2Str/File2Str.hpp"
     #include "Flare/Flare.hpp"
+    #include "Future/Future.hpp"
     #include "Ips/Ips.hpp"
+    #include "Job/Job.hpp"
     #include "JoinThread/JoinThread.hpp"
     #include "Logger/Logger.hpp"
     #include "Math/Math.hpp"
     #include "Mixin/Mixin.hpp"
+    #include "MpscQueue/MpscQueue.hpp"
+    #include "Padded/Padded.hpp"
     #include "Profiler/Profiler.hpp"
+    #include "Ring/MpmcRing.hpp"
+    #include "Ring/SpscRing.hpp"
     #include "Rit/Rit.hpp"
     #include "Rtc/Rtc.hpp"
     #include "Runnable/Runnable.hpp"
@@ -41,7 +50,11 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
     #include "Singleton/Singleton.hpp"
     #include "ScopedFunction/ScopedFunction.hpp"
     #include "Sleep/Sleep.hpp"
+    #include "Synched/SequenceSynched.hpp"
+    #include "Synched/ShardedSynched.hpp"
+    #include "Synched/SnapshotSynched.hpp"
     #include "Synched/Synched.hpp"
+    #include "TaskGraph/TaskGraph.hpp"
     #include "Valman/Valman.hpp"
     #include "Utilities/Utilities.hpp"
     #include "Worker/Worker.hpp"
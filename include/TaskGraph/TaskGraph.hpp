@@ -0,0 +1,162 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TASKGRAPH_HPP_INCLUDED
+#define TASKGRAPH_HPP_INCLUDED
+
+// Headers
+#include <TTL/BatchWorker/BatchWorker.hpp>
+#include <TTL/Flare/Flare.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    /// \brief Tasks that run as soon as their predecessors are done
+    ///
+    /// Tasks run on the workers of a BatchWorker. A task becomes
+    /// runnable the moment its last predecessor finishes, so a
+    /// slow task only delays the tasks that depend on it.
+    ///
+    ////////////////////////////////////////////////////////////
+    class TaskGraph
+    {
+    public:
+
+        typedef Sti_t Task; ///< Identifies a task within its graph
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor
+        ///
+        ////////////////////////////////////////////////////////////
+        TaskGraph();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Add a task without predecessors
+        ///
+        /// \return The task, to be used with precede
+        ///
+        ////////////////////////////////////////////////////////////
+        template <typename FUNCTION>
+        Task addTask(FUNCTION function)
+        {
+            m_tasks.emplace_back(std::function<void()>(std::move(function)));
+            m_acyclic = false;
+            return m_tasks.size() - 1;
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Make after wait for before
+        ///
+        ////////////////////////////////////////////////////////////
+        void precede(const Task before, const Task after);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Run every task once, and wait for all of them
+        ///
+        /// The graph can be run any amount of times. The calling
+        /// thread only waits. Called from one of the pool's own
+        /// workers, which could wait on tasks queued behind it,
+        /// the tasks run one after another on that worker instead.
+        ///
+        /// \throw std::invalid_argument if the tasks depend on
+        /// each other in a cycle
+        ///
+        ////////////////////////////////////////////////////////////
+        void run(BatchWorker &pool);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Get the amount of tasks
+        ///
+        ////////////////////////////////////////////////////////////
+        Sti_t getTaskCount() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Remove all tasks
+        ///
+        ////////////////////////////////////////////////////////////
+        void clear();
+
+    private:
+
+        ////////////////////////////////////////////////////////////
+        struct Node
+        {
+            explicit Node(std::function<void()> function);
+
+            std::function<void()> function;
+            std::vector<Task> successors;
+            Sti_t predecessors;
+            std::atomic<Sti_t> pending; ///< Predecessors that have not yet finished this run
+        };
+
+        ////////////////////////////////////////////////////////////
+        void execute(BatchWorker &pool, Task task);
+
+        ////////////////////////////////////////////////////////////
+        void executeInline();
+
+        ////////////////////////////////////////////////////////////
+        void checkAcyclic();
+
+        std::deque<Node> m_tasks; ///< All tasks, a deque since nodes can not move
+        std::atomic<Sti_t> m_remaining; ///< Tasks that have not yet finished this run
+        ttl::Flare m_done; ///< Notified when the last task finishes
+        bool m_acyclic; ///< Whether the graph was checked for cycles since it last changed
+
+    };
+
+} // Namespace ttl
+
+#endif // TASKGRAPH_HPP_INCLUDED
+
+
+////////////////////////////////////////////////////////////
+/// \class TaskGraph
+///
+/// Instead of a barrier after every stage of a pipeline,
+/// declare which task needs which:
+///
+/// \code
+/// ttl::BatchWorker pool(8);
+/// ttl::TaskGraph graph;
+/// auto parse = graph.addTask([&]{parseInput();});
+/// auto index = graph.addTask([&]{buildIndex();});
+/// auto stats = graph.addTask([&]{countWords();});
+/// auto aggregate = graph.addTask([&]{writeReport();});
+/// graph.precede(parse, index);
+/// graph.precede(parse, stats);
+/// graph.precede(index, aggregate);
+/// graph.precede(stats, aggregate);
+/// graph.run(pool);
+/// \endcode
+///
+/// index and stats run at the same time, and aggregate starts
+/// as soon as both are done. A task may itself call fer on
+/// the pool, the loop then uses the other workers as well.
+///
+////////////////////////////////////////////////////////////
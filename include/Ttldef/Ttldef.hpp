@@ -30,6 +30,8 @@ namespace ttl
 
     typedef std::size_t Sti_t;
 
+    constexpr Sti_t cache_line_size = 64; ///< Assumed size of a cache line in bytes
+
 } // Namespace ttl
 
 #endif // TTLDEF_HPP_INCLUDED
@@ -23,8 +23,17 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 
 // Headers
 #include <TTL/Flare/Flare.hpp>
+#include <TTL/Future/Future.hpp>
+#include <TTL/Job/Job.hpp>
 #include <TTL/JoinThread/JoinThread.hpp>
-#include <functional>
+#include <TTL/MpscQueue/MpscQueue.hpp>
+#include <TTL/Ttldef/Ttldef.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 namespace ttl
@@ -40,6 +49,10 @@ namespace ttl
     /// both thread management and the actual work itself will
     /// be sent into the Worker from within ThreadPool.
     ///
+    /// Work is kept in a bounded lock-free queue, so any amount
+    /// of threads can issue work at the same time. Work is
+    /// stored as a ttl::Job, so issuing never allocates.
+    ///
     ////////////////////////////////////////////////////////////
     class Worker
     {
@@ -56,10 +69,24 @@ namespace ttl
         template <typename T>
         Worker(T function)
         :
-            m_work_available(true),
-            m_work(function),
+            m_idle_timeout(0),
+            m_running(true),
+            m_state(AWAKE),
             m_thread(&Worker::work, this)
-        {}
+        {
+            issueWork(std::move(function));
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Constructor with a function run by every thread
+        ///
+        /// on_start runs on the worker's thread before any work,
+        /// and again whenever a retired worker starts a new thread.
+        ///
+        /// \param start Whether to start the thread now, or only
+        /// once work is issued
+        ////////////////////////////////////////////////////////////
+        Worker(Job on_start, bool start);
 
         ////////////////////////////////////////////////////////////
         /// \brief Destructor
@@ -67,19 +94,83 @@ namespace ttl
         ~Worker();
 
         ////////////////////////////////////////////////////////////
-        /// \brief Sets the work to be done and activates the worker
+        /// \brief Adds work to the queue and activates the worker
         ///
-        /// If this function is called before the worker can wake up
-        /// then behaviour is well-defined. The worker will work with
-        /// the latest update.
+        /// Can be called from any thread. Work is done in the order
+        /// it was issued, and no work is lost if this function is
+        /// called before the worker wakes up. If the queue is full,
+        /// this function yields until the worker makes room.
         ////////////////////////////////////////////////////////////
         template <typename T>
-        void issueWork(const T function)
+        void issueWork(T function)
         {
-            m_work = function;
-            m_work_available.notify();
+            Job job(std::move(function));
+            while (this->tryIssueWork(job) == false)
+            {
+                std::this_thread::yield();
+            }
         }
 
+        ////////////////////////////////////////////////////////////
+        /// \brief Adds work whose return value is put in a future
+        ///
+        /// The future must outlive the work, and may be given a
+        /// continuation, which then runs on this worker.
+        ///
+        /// \see Future
+        ////////////////////////////////////////////////////////////
+        template <typename T, typename FUNCTION>
+        void issueWork(Future<T> &future, FUNCTION function)
+        {
+            Promise<T> promise(future.getPromise());
+            this->issueWork([promise, function]() mutable {promise.setValueFrom(function);});
+        }
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Adds work to the queue unless the queue is full
+        ///
+        /// Can be called from any thread. The job is moved from
+        /// only if it was queued.
+        ///
+        /// \return true if the job was queued
+        ////////////////////////////////////////////////////////////
+        bool tryIssueWork(Job &job);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Set how long the worker spins before sleeping
+        ///
+        /// \see Flare::setSpinCount
+        ////////////////////////////////////////////////////////////
+        void setSpinCount(const Sti_t spin_count);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Let the worker's thread exit after idling
+        ///
+        /// A retired worker starts a new thread as soon as work is
+        /// issued to it, so no work is lost. 0 never retires.
+        ///
+        ////////////////////////////////////////////////////////////
+        void setIdleTimeout(const std::chrono::nanoseconds timeout);
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Check if the worker's thread has exited
+        ///
+        ////////////////////////////////////////////////////////////
+        bool isRetired() const;
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Restrict the worker to a set of cpus
+        ///
+        /// Only supported on Linux.
+        ///
+        /// \param cpus The indices of the cpus the worker may run on
+        /// \return true if the worker was moved to the cpus, or
+        /// will be when its next thread starts
+        ////////////////////////////////////////////////////////////
+        bool setAffinity(const std::vector<Sti_t> &cpus);
+
+        static constexpr Sti_t queue_capacity = 1024; ///< Amount of work that can be queued
+
     private:
 
         ////////////////////////////////////////////////////////////
@@ -87,8 +178,31 @@ namespace ttl
         ////////////////////////////////////////////////////////////
         void work();
 
-        ttl::Flare m_work_available; ///< Notified when work is added
-        std::function<void()> m_work; ///< The work to be done
+        ////////////////////////////////////////////////////////////
+        /// \brief Start a new thread for a retired worker
+        ////////////////////////////////////////////////////////////
+        void restart();
+
+        ////////////////////////////////////////////////////////////
+        /// \brief Apply m_cpus to m_thread, m_thread_mutex must be held
+        ////////////////////////////////////////////////////////////
+        bool applyAffinity();
+
+        enum : Sti_t
+        {
+            AWAKE, ///< Working, or about to look at the queue
+            SLEEPING, ///< May be waiting on m_work_available
+            RETIRED ///< The thread has exited
+        };
+
+        ttl::Flare m_work_available; ///< Notified when work is added to an idle worker
+        ttl::MpscQueue<Job> m_queue{queue_capacity}; ///< The work to be done
+        Job m_on_start; ///< Run at the start of every thread, if given
+        std::atomic<std::chrono::nanoseconds::rep> m_idle_timeout; ///< Idle time after which the thread exits, 0 for never
+        std::atomic<bool> m_running; ///< Cleared when the worker should stop once idle
+        std::atomic<Sti_t> m_state; ///< One of AWAKE, SLEEPING, RETIRED
+        std::mutex m_thread_mutex; ///< Guards m_thread and m_cpus against restarts
+        std::vector<Sti_t> m_cpus; ///< The cpus the worker may run on, empty for any
         ttl::JoinThread m_thread; ///< The thread that works
 
     };
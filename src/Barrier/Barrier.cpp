@@ -0,0 +1,110 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Headers
+#include "Barrier/Barrier.hpp"
+#include "Sleep/Sleep.hpp"
+
+
+namespace ttl
+{
+
+    namespace
+    {
+        const Sti_t sense_bit = 1; ///< Flips every time the last thread arrives
+        const Sti_t flipped_locked = 2; ///< The last flip happened under m_mx, which its thread may still hold
+        const Sti_t sleeper = 4; ///< One thread sleeping on the condition variable
+    }
+
+    ////////////////////////////////////////////////////////////
+    Barrier::Barrier(const Sti_t threads, const Sti_t spin_count)
+    :
+        m_threads(threads),
+        m_remaining(threads),
+        m_state(0),
+        m_spin_count(spin_count)
+    {}
+
+    ////////////////////////////////////////////////////////////
+    bool Barrier::wait()
+    {
+        // The sense cannot flip before this thread has arrived
+        const Sti_t sense = m_state.load(std::memory_order_relaxed) & sense_bit;
+        if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            m_remaining.store(m_threads, std::memory_order_relaxed);
+            // The flip must be our last touch of the barrier, the others
+            // may return and destroy it as soon as they see it
+            Sti_t state = m_state.load();
+            do
+            {
+                if (state >= sleeper)
+                {
+                    // Sleepers only come and go under m_mx, and spinning threads
+                    // that see flipped_locked wait for m_mx, and with it for us
+                    std::lock_guard<std::mutex> lock(m_mx);
+                    m_state.store((m_state.load() ^ sense_bit) | flipped_locked);
+                    m_cndvar.notify_all();
+                    return true;
+                }
+            }
+            while (m_state.compare_exchange_weak(state, (state ^ sense_bit) & ~flipped_locked) == false);
+            return true;
+        }
+
+        for (Sti_t i = m_spin_count.load(std::memory_order_relaxed); i > 0; --i)
+        {
+            const Sti_t state = m_state.load(std::memory_order_acquire);
+            if ((state & sense_bit) != sense)
+            {
+                if (state & flipped_locked)
+                {
+                    std::lock_guard<std::mutex> lock(m_mx); // The last arrival may still be inside
+                }
+                return false;
+            }
+            cpuRelax();
+        }
+        std::unique_lock<std::mutex> lock(m_mx);
+        m_state.fetch_add(sleeper); // Seen by the last arrival if it flips after our check below
+        m_cndvar.wait(lock, [this, sense]() -> bool {return (m_state.load() & sense_bit) != sense;});
+        m_state.fetch_sub(sleeper);
+        return false;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t Barrier::getThreadCount() const
+    {
+        return m_threads;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Barrier::setSpinCount(const Sti_t spin_count)
+    {
+        m_spin_count.store(spin_count, std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t Barrier::getSpinCount() const
+    {
+        return m_spin_count.load(std::memory_order_relaxed);
+    }
+
+} // Namespace ttl
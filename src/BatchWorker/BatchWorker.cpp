@@ -21,50 +21,407 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 // Headers
 #include "BatchWorker/BatchWorker.hpp"
 #include "Debug/Debug.hpp"
+#include <fstream>
+#include <sstream>
+#include <string>
+#ifdef __linux__
+    #include <sched.h>
+#endif
 
 
 namespace ttl
 {
 
+    namespace
+    {
+
+        ////////////////////////////////////////////////////////////
+        std::vector<Sti_t> parseCpuList(const std::string &list)
+        {
+            // Such as "0-3,8-11"
+            std::vector<Sti_t> cpus;
+            std::istringstream stream(list);
+            Sti_t first;
+            while (stream >> first)
+            {
+                Sti_t last = first;
+                if (stream.peek() == '-')
+                {
+                    stream.get();
+                    stream >> last;
+                }
+                for (Sti_t cpu(first); cpu <= last; ++cpu)
+                {
+                    cpus.push_back(cpu);
+                }
+                if (stream.peek() == ',')
+                {
+                    stream.get();
+                }
+            }
+            return cpus;
+        }
+
+        ////////////////////////////////////////////////////////////
+        std::vector<std::vector<Sti_t>> getCpusByNode()
+        {
+            std::vector<std::vector<Sti_t>> nodes;
+            #ifdef __linux__
+                cpu_set_t allowed;
+                if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+                {
+                    return nodes;
+                }
+
+                for (Sti_t node(0);; ++node)
+                {
+                    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                    std::string list;
+                    if (!std::getline(file, list))
+                    {
+                        break;
+                    }
+                    nodes.emplace_back();
+                    for (const Sti_t cpu : parseCpuList(list))
+                    {
+                        if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                        {
+                            nodes.back().push_back(cpu);
+                        }
+                    }
+                }
+
+                if (nodes.empty()) // No NUMA information, a single node
+                {
+                    nodes.emplace_back();
+                    for (Sti_t cpu(0); cpu < CPU_SETSIZE; ++cpu)
+                    {
+                        if (CPU_ISSET(cpu, &allowed))
+                        {
+                            nodes.back().push_back(cpu);
+                        }
+                    }
+                }
+            #endif
+            return nodes;
+        }
+
+    } // Anonymous namespace
+
+    ////////////////////////////////////////////////////////////
+    thread_local BatchWorker::Participant BatchWorker::current_participant = {nullptr, 0};
+
+    ////////////////////////////////////////////////////////////
+    thread_local BatchWorker::Participant BatchWorker::current_worker = {nullptr, 0};
+
+    ////////////////////////////////////////////////////////////
+    BatchWorker::Caller::Caller(BatchWorker &pool)
+    :
+        m_pool(pool),
+        m_id(pool.m_thread_pool.size()),
+        m_inline(false),
+        m_owns(false)
+    {
+        if (pool.isNested(m_id))
+        {
+            m_inline = true;
+        }
+        else if (current_worker.pool == &pool)
+        {
+            // Blocking here could wait on a loop that waits for this worker
+            m_id = current_worker.id;
+            m_owns = pool.m_batch_mutex.try_lock();
+            m_inline = m_owns == false || pool.m_has_waited == false;
+        }
+        else
+        {
+            pool.m_batch_mutex.lock();
+            m_owns = true;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    BatchWorker::Caller::~Caller()
+    {
+        if (m_owns)
+        {
+            m_pool.m_batch_mutex.unlock();
+        }
+    }
+
     ////////////////////////////////////////////////////////////
     BatchWorker::BatchWorker()
     :
+        m_active(0),
+        m_peak(0),
+        m_backlog(0),
+        m_unfinished(1),
+        m_elasticity{0, 0, 0, std::chrono::milliseconds(0)},
         m_actively_working(0),
-        m_has_waited(true)
+        m_has_waited(true),
+        m_spin_count(0),
+        m_schedule(Schedule::Strided),
+        m_grain(0),
+        m_min_block(0),
+        m_next_worker(0),
+        m_affinity(Affinity::None),
+        m_cancelled(false),
+        m_deques(new Padded<std::atomic<std::uint64_t>>[1]),
+        m_detached(nullptr),
+        m_detached_inline(false)
     {
     }
 
     ////////////////////////////////////////////////////////////
     BatchWorker::BatchWorker(const Sti_t worker_count)
     :
+        m_active(0),
+        m_peak(0),
+        m_backlog(0),
+        m_unfinished(1),
+        m_elasticity{0, 0, 0, std::chrono::milliseconds(0)},
         m_actively_working(0),
-        m_has_waited(true)
+        m_has_waited(true),
+        m_spin_count(0),
+        m_schedule(Schedule::Strided),
+        m_grain(0),
+        m_min_block(0),
+        m_next_worker(0),
+        m_affinity(Affinity::None),
+        m_cancelled(false),
+        m_detached(nullptr),
+        m_detached_inline(false)
     {
         setWorkerCount(worker_count);
     }
 
     ////////////////////////////////////////////////////////////
     BatchWorker::~BatchWorker()
-    {}
+    {
+        this->settle();
+        this->drain();
+        m_thread_pool.clear(); // Before the members that queued work may still use
+    }
 
     ////////////////////////////////////////////////////////////
     void BatchWorker::setWorkerCount(const Sti_t workers)
     {
-        if (m_thread_pool.size() > workers)
+        this->drain(); // Queued functions use the workers and m_elasticity
+        this->settle();
+        m_elasticity = {workers, workers, 0, std::chrono::milliseconds(0)};
+        this->resize();
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t BatchWorker::getWorkerCount() const
+    {
+        Sti_t active(m_active);
+        while (active > m_elasticity.core && m_thread_pool[active - 1]->isRetired())
         {
-            m_thread_pool.erase(m_thread_pool.begin() + workers, m_thread_pool.end());
-            return;
+            --active;
         }
-        for (; m_thread_pool.size() < workers;)
+        return active;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::setElasticity(const Elasticity &elasticity)
+    {
+        this->drain();
+        this->settle();
+        m_elasticity = elasticity;
+        m_elasticity.maximum = std::max(elasticity.core, elasticity.maximum);
+        this->resize();
+    }
+
+    ////////////////////////////////////////////////////////////
+    BatchWorker::Elasticity BatchWorker::getElasticity() const
+    {
+        return m_elasticity;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t BatchWorker::getPeakWorkerCount() const
+    {
+        return m_peak;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::setSpinCount(const Sti_t spin_count)
+    {
+        m_spin_count = spin_count;
+        m_threads_done.setSpinCount(spin_count);
+        for (std::unique_ptr<Worker> &worker : m_thread_pool)
         {
-            m_thread_pool.emplace_back(new Worker);
+            worker->setSpinCount(spin_count);
         }
     }
 
     ////////////////////////////////////////////////////////////
-    Sti_t BatchWorker::getWorkerCount() const
+    Sti_t BatchWorker::getSpinCount() const
+    {
+        return m_spin_count;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool BatchWorker::setAffinity(const Affinity affinity)
     {
-        return m_thread_pool.size();
+        m_affinity = affinity;
+        return this->applyAffinity();
+    }
+
+    ////////////////////////////////////////////////////////////
+    BatchWorker::Affinity BatchWorker::getAffinity() const
+    {
+        return m_affinity;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool BatchWorker::waitFor(const std::chrono::nanoseconds timeout)
+    {
+        if (m_has_waited == false)
+        {
+            if (m_threads_done.waitFor(timeout) == false)
+            {
+                return false;
+            }
+            m_has_waited = true;
+        }
+        this->settle();
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::cancel()
+    {
+        m_cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool BatchWorker::isCancelled() const
+    {
+        return m_cancelled.load(std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::setSchedule(const Schedule schedule)
+    {
+        m_schedule = schedule;
+    }
+
+    ////////////////////////////////////////////////////////////
+    BatchWorker::Schedule BatchWorker::getSchedule() const
+    {
+        return m_schedule;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::setGrainSize(const Sti_t grain)
+    {
+        m_grain = grain;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t BatchWorker::getGrainSize() const
+    {
+        return m_grain;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::setMinimumBlockSize(const Sti_t elements)
+    {
+        m_min_block = elements;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t BatchWorker::getMinimumBlockSize() const
+    {
+        return m_min_block;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool BatchWorker::takeChunk(std::atomic<std::uint64_t> &range, Sti_t &chunk)
+    {
+        std::uint64_t current = range.load();
+        for (;;)
+        {
+            const std::uint64_t first = current >> 32, last = current & max_chunks;
+            if (first >= last)
+            {
+                return false;
+            }
+            if (range.compare_exchange_weak(current, packRange(first + 1, last)))
+            {
+                chunk = first;
+                return true;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool BatchWorker::stealChunks(Padded<std::atomic<std::uint64_t>> *ranges, const Sti_t count, const Sti_t thief)
+    {
+        for (Sti_t i(1); i < count; ++i)
+        {
+            std::atomic<std::uint64_t> &victim = *ranges[(thief + i) % count];
+            std::uint64_t current = victim.load();
+            for (;;)
+            {
+                const std::uint64_t first = current >> 32, last = current & max_chunks;
+                if (first >= last)
+                {
+                    break;
+                }
+                const std::uint64_t stolen = (last - first + 1) / 2;
+                if (victim.compare_exchange_weak(current, packRange(first, last - stolen)))
+                {
+                    ranges[thief]->store(packRange(last - stolen, last));
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::settle()
+    {
+        if (m_has_waited.fetchAndSet(true) == false)
+        {
+            this->wait();
+        }
+        if (m_detached)
+        {
+            if (m_detached_inline)
+            {
+                m_detached->~Detached();
+            }
+            else
+            {
+                delete m_detached;
+            }
+            m_detached = nullptr;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool BatchWorker::tryIssueJob(Job &job)
+    {
+        Sti_t thread_pool_size(this->getActiveWorkerCount());
+        if (thread_pool_size < m_elasticity.maximum && (thread_pool_size == 0 || m_backlog.load(std::memory_order_relaxed) >= m_elasticity.threshold * thread_pool_size))
+        {
+            thread_pool_size = this->addActiveWorker(thread_pool_size);
+        }
+
+        // Start at the next worker in turn, and pass over the full queues
+        const Sti_t first(thread_pool_size > 0 ? m_next_worker++ : 0);
+        for (Sti_t i(0); i < thread_pool_size; ++i)
+        {
+            if (m_thread_pool[(first + i) % thread_pool_size]->tryIssueWork(job))
+            {
+                return true;
+            }
+        }
+        return false;
     }
 
     ////////////////////////////////////////////////////////////
@@ -73,5 +430,107 @@ namespace ttl
         m_threads_done.wait();
     }
 
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::drain()
+    {
+        // Whoever takes the count to 0 is the last to touch it, and only then do we wait
+        if (m_unfinished.fetch_sub(1) != 1)
+        {
+            m_idle.wait();
+        }
+        m_unfinished = 1;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void BatchWorker::resize()
+    {
+        const Sti_t core(m_elasticity.core), maximum(m_elasticity.maximum);
+        m_deques.reset(new Padded<std::atomic<std::uint64_t>>[maximum + 1]);
+        if (m_thread_pool.size() > maximum)
+        {
+            m_thread_pool.erase(m_thread_pool.begin() + maximum, m_thread_pool.end());
+        }
+        while (m_thread_pool.size() < maximum)
+        {
+            // Only a block marks its thread as a participant, a worker otherwise starts loops of its own
+            const Sti_t id(m_thread_pool.size());
+            m_thread_pool.emplace_back(new Worker([this, id]() {current_worker = {this, id};}, id < core));
+            m_thread_pool.back()->setSpinCount(m_spin_count);
+        }
+        for (Sti_t i(0); i < maximum; ++i)
+        {
+            m_thread_pool[i]->setIdleTimeout(i < core ? std::chrono::nanoseconds(0) : std::chrono::nanoseconds(m_elasticity.idle_timeout));
+        }
+
+        m_active = core;
+        m_peak = std::max(m_peak.load(), core);
+        if (m_affinity != Affinity::None)
+        {
+            this->applyAffinity();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t BatchWorker::getActiveWorkerCount()
+    {
+        // Give up the retired workers at the top
+        Sti_t active(m_active);
+        while (active > m_elasticity.core && m_thread_pool[active - 1]->isRetired())
+        {
+            if (m_active.compare_exchange_weak(active, active - 1))
+            {
+                --active;
+            }
+        }
+        return active;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t BatchWorker::addActiveWorker(Sti_t active)
+    {
+        if (m_active.compare_exchange_strong(active, active + 1))
+        {
+            ++active;
+        }
+        Sti_t peak(m_peak);
+        while (peak < active && m_peak.compare_exchange_weak(peak, active) == false);
+        return active;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool BatchWorker::applyAffinity()
+    {
+        const std::vector<std::vector<Sti_t>> nodes = getCpusByNode();
+        std::vector<Sti_t> all, node_of;
+        for (Sti_t node(0); node < nodes.size(); ++node)
+        {
+            all.insert(all.end(), nodes[node].begin(), nodes[node].end());
+            node_of.insert(node_of.end(), nodes[node].size(), node);
+        }
+        if (all.empty())
+        {
+            return false;
+        }
+
+        bool moved = true;
+        for (Sti_t i(0); i < m_thread_pool.size(); ++i)
+        {
+            const Sti_t position = i % all.size();
+            if (m_affinity == Affinity::Core)
+            {
+                moved = m_thread_pool[i]->setAffinity({all[position]}) && moved;
+            }
+            else if (m_affinity == Affinity::Node)
+            {
+                moved = m_thread_pool[i]->setAffinity(nodes[node_of[position]]) && moved;
+            }
+            else
+            {
+                moved = m_thread_pool[i]->setAffinity(all) && moved;
+            }
+        }
+        return moved;
+    }
+
 
 } // Namespace ttl
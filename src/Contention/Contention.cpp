@@ -0,0 +1,263 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+// Headers
+#include "Contention/Contention.hpp"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+
+namespace ttl
+{
+
+    namespace
+    {
+
+        ////////////////////////////////////////////////////////////
+        std::mutex &getRegistryMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        ////////////////////////////////////////////////////////////
+        std::vector<Contention *> &getRegistry()
+        {
+            static std::vector<Contention *> registry;
+            return registry;
+        }
+
+        ////////////////////////////////////////////////////////////
+        void writeTime(std::ostream &out, const Sti_t nanoseconds)
+        {
+            if (nanoseconds >= 1000000000)
+                out << nanoseconds / 1E9 << " s";
+            else if (nanoseconds >= 1000000)
+                out << nanoseconds / 1E6 << " ms";
+            else if (nanoseconds >= 1000)
+                out << nanoseconds / 1E3 << " µs";
+            else
+                out << nanoseconds << " ns";
+        }
+
+        ////////////////////////////////////////////////////////////
+        Sti_t toNanoseconds(const Contention::Clock::duration duration)
+        {
+            return static_cast<Sti_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        }
+
+    } // Anonymous namespace
+
+    ////////////////////////////////////////////////////////////
+    Contention::Counts &Contention::Counts::operator+=(const Counts &counts)
+    {
+        reads += counts.reads;
+        writes += counts.writes;
+        timeouts += counts.timeouts;
+        notifications += counts.notifications;
+        read_wait += counts.read_wait;
+        write_wait += counts.write_wait;
+        max_wait = std::max(max_wait, counts.max_wait);
+        max_hold = std::max(max_hold, counts.max_hold);
+        max_readers = std::max(max_readers, counts.max_readers);
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Contention::Contention(const char *kind, const std::string &name)
+    :
+        m_kind(kind),
+        m_name(name),
+        m_reads(0),
+        m_writes(0),
+        m_timeouts(0),
+        m_notifications(0),
+        m_read_wait(0),
+        m_write_wait(0),
+        m_max_wait(0),
+        m_max_hold(0),
+        m_max_readers(0)
+    {
+        std::lock_guard<std::mutex> lock(getRegistryMutex());
+        getRegistry().push_back(this);
+    }
+
+    ////////////////////////////////////////////////////////////
+    Contention::~Contention()
+    {
+        std::lock_guard<std::mutex> lock(getRegistryMutex());
+        std::vector<Contention *> &registry = getRegistry();
+        registry.erase(std::find(registry.begin(), registry.end(), this));
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::addRead(const Clock::duration wait, const Sti_t readers)
+    {
+        const Sti_t waited = toNanoseconds(wait);
+        m_reads.fetch_add(1, std::memory_order_relaxed);
+        m_read_wait.fetch_add(waited, std::memory_order_relaxed);
+        raise(m_max_wait, waited);
+        raise(m_max_readers, readers);
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::addWrite(const Clock::duration wait)
+    {
+        const Sti_t waited = toNanoseconds(wait);
+        m_writes.fetch_add(1, std::memory_order_relaxed);
+        m_write_wait.fetch_add(waited, std::memory_order_relaxed);
+        raise(m_max_wait, waited);
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::addHold(const Clock::duration hold)
+    {
+        raise(m_max_hold, toNanoseconds(hold));
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::addTimeout()
+    {
+        m_timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::addNotification()
+    {
+        m_notifications.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////
+    Contention::Counts Contention::getCounts() const
+    {
+        Counts counts;
+        counts.reads = m_reads.load(std::memory_order_relaxed);
+        counts.writes = m_writes.load(std::memory_order_relaxed);
+        counts.timeouts = m_timeouts.load(std::memory_order_relaxed);
+        counts.notifications = m_notifications.load(std::memory_order_relaxed);
+        counts.read_wait = m_read_wait.load(std::memory_order_relaxed);
+        counts.write_wait = m_write_wait.load(std::memory_order_relaxed);
+        counts.max_wait = m_max_wait.load(std::memory_order_relaxed);
+        counts.max_hold = m_max_hold.load(std::memory_order_relaxed);
+        counts.max_readers = m_max_readers.load(std::memory_order_relaxed);
+        return counts;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::reset()
+    {
+        for (std::atomic<Sti_t> *counter : {&m_reads, &m_writes, &m_timeouts, &m_notifications, &m_read_wait, &m_write_wait, &m_max_wait, &m_max_hold, &m_max_readers})
+        {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::setName(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(getRegistryMutex());
+        m_name = name;
+    }
+
+    ////////////////////////////////////////////////////////////
+    std::string Contention::getName() const
+    {
+        std::lock_guard<std::mutex> lock(getRegistryMutex());
+        return m_name;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::writeReport(std::ostream &out)
+    {
+        std::map<std::pair<std::string, std::string>, Counts> merged;
+        {
+            std::lock_guard<std::mutex> lock(getRegistryMutex());
+            for (const Contention *contention : getRegistry())
+            {
+                merged[std::make_pair(std::string(contention->m_kind), contention->m_name)] += contention->getCounts();
+            }
+        }
+        std::vector<std::pair<std::pair<std::string, std::string>, Counts>> lines(merged.begin(), merged.end());
+        std::stable_sort
+        (
+            lines.begin(), lines.end(),
+            [](const decltype(lines)::value_type &lhs, const decltype(lines)::value_type &rhs) -> bool
+            {
+                return lhs.second.read_wait + lhs.second.write_wait > rhs.second.read_wait + rhs.second.write_wait;
+            }
+        );
+        for (const auto &line : lines)
+        {
+            const Counts &counts = line.second;
+            out
+                << line.first.first << " \"" << line.first.second << "\": "
+                << counts.reads << " reads, "
+                << counts.writes << " writes, ";
+            if (counts.writes != 0)
+                out << static_cast<double>(counts.reads) / counts.writes << " reads per write, ";
+            out << "waited ";
+            writeTime(out, counts.read_wait + counts.write_wait);
+            out << " (reads ";
+            writeTime(out, counts.read_wait);
+            out << ", writes ";
+            writeTime(out, counts.write_wait);
+            out << "), max wait ";
+            writeTime(out, counts.max_wait);
+            out << ", max hold ";
+            writeTime(out, counts.max_hold);
+            out
+                << ", " << counts.max_readers << " readers at most, "
+                << counts.timeouts << " timeouts, "
+                << counts.notifications << " notifications" << std::endl;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    std::string Contention::getReport()
+    {
+        std::ostringstream out;
+        writeReport(out);
+        return out.str();
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::resetAll()
+    {
+        std::lock_guard<std::mutex> lock(getRegistryMutex());
+        for (Contention *contention : getRegistry())
+        {
+            contention->reset();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Contention::raise(std::atomic<Sti_t> &maximum, const Sti_t value)
+    {
+        Sti_t current = maximum.load(std::memory_order_relaxed);
+        while (current < value && maximum.compare_exchange_weak(current, value, std::memory_order_relaxed) == false)
+        {}
+    }
+
+} // Namespace ttl
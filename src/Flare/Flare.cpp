@@ -20,15 +20,24 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 
 // Headers
 #include "Flare/Flare.hpp"
+#include "Sleep/Sleep.hpp"
 
 
 namespace ttl
 {
 
+    namespace
+    {
+        const Sti_t notified = 1; ///< A notification is pending
+        const Sti_t notified_locked = 2; ///< It was published under m_mx, which its notifier may still hold
+        const Sti_t sleeper = 4; ///< One thread sleeping on the condition variable
+    }
+
     ////////////////////////////////////////////////////////////
-    Flare::Flare(bool skip_on_first_wait)
+    Flare::Flare(bool skip_on_first_wait, const Sti_t spin_count)
     :
-        m_notifications(skip_on_first_wait){}
+        m_state(skip_on_first_wait ? notified : 0),
+        m_spin_count(spin_count){}
 
     ////////////////////////////////////////////////////////////
     Flare::~Flare(){}
@@ -36,33 +45,136 @@ namespace ttl
     ////////////////////////////////////////////////////////////
     void Flare::notify()
     {
-        std::lock_guard<std::mutex> lock(m_mx);
-        m_notifications = true;
-        m_cndvar.notify_one();
+        notify_one();
     }
 
     ////////////////////////////////////////////////////////////
     void Flare::notify_one()
     {
-        std::lock_guard<std::mutex> lock(m_mx);
-        m_notifications = true;
-        m_cndvar.notify_one();
+        TTL_CONTENTION_SCOPE(m_contention.addNotification();)
+        this->publish([this]() {m_cndvar.notify_one();});
     }
 
     ////////////////////////////////////////////////////////////
     void Flare::notify_all()
     {
-        std::lock_guard<std::mutex> lock(m_mx);
-        m_notifications = true;
-        m_cndvar.notify_all();
+        TTL_CONTENTION_SCOPE(m_contention.addNotification();)
+        this->publish([this]() {m_cndvar.notify_all();});
+    }
+
+    ////////////////////////////////////////////////////////////
+    template <typename CONDITION_VARIABLE_NOTIFY>
+    void Flare::publish(CONDITION_VARIABLE_NOTIFY notify)
+    {
+        // The publishing store must be our last touch of the flare,
+        // a waiter may see it, return and destroy the flare at once
+        Sti_t state = m_state.load();
+        do
+        {
+            if (state >= sleeper)
+            {
+                // Sleepers registered under m_mx, so they are asleep by now. A
+                // waiter that takes the notification outside the lock waits for
+                // m_mx, and with it for us, because of notified_locked
+                std::lock_guard<std::mutex> lock(m_mx);
+                m_state.fetch_or(notified | notified_locked);
+                notify();
+                return;
+            }
+        }
+        while (m_state.compare_exchange_weak(state, state | notified) == false);
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool Flare::consume()
+    {
+        Sti_t state = m_state.load(std::memory_order_relaxed);
+        while (state & notified)
+        {
+            if (m_state.compare_exchange_weak(state, state & ~(notified | notified_locked)))
+            {
+                if (state & notified_locked)
+                {
+                    std::lock_guard<std::mutex> lock(m_mx); // Its notifier may still be inside
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool Flare::consumeLocked()
+    {
+        Sti_t state = m_state.load(std::memory_order_relaxed);
+        while (state & notified)
+        {
+            if (m_state.compare_exchange_weak(state, state & ~(notified | notified_locked)))
+            {
+                return true;
+            }
+        }
+        return false;
     }
 
     ////////////////////////////////////////////////////////////
     void Flare::wait()
     {
+        TTL_CONTENTION_SCOPE(const Contention::Clock::time_point start = Contention::Clock::now();)
+        for (Sti_t i = m_spin_count.load(std::memory_order_relaxed); i > 0; --i)
+        {
+            if (this->consume())
+            {
+                TTL_CONTENTION_SCOPE(m_contention.addWrite(Contention::Clock::now() - start);)
+                return;
+            }
+            cpuRelax();
+        }
+        std::unique_lock<std::mutex> lock(m_mx);
+        m_state.fetch_add(sleeper); // A notifier that publishes after our check below sees us
+        m_cndvar.wait(lock, [this]() -> bool {return this->consumeLocked();});
+        m_state.fetch_sub(sleeper);
+        TTL_CONTENTION_SCOPE(m_contention.addWrite(Contention::Clock::now() - start);)
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool Flare::waitFor(const std::chrono::nanoseconds timeout)
+    {
+        TTL_CONTENTION_SCOPE(const Contention::Clock::time_point start = Contention::Clock::now();)
+        for (Sti_t i = m_spin_count.load(std::memory_order_relaxed); i > 0; --i)
+        {
+            if (this->consume())
+            {
+                TTL_CONTENTION_SCOPE(m_contention.addWrite(Contention::Clock::now() - start);)
+                return true;
+            }
+            cpuRelax();
+        }
         std::unique_lock<std::mutex> lock(m_mx);
-        m_cndvar.wait(lock, [this]() -> bool {return this->m_notifications;});
-        m_notifications = false;
+        m_state.fetch_add(sleeper);
+        const bool notified_in_time = m_cndvar.wait_for(lock, timeout, [this]() -> bool {return this->consumeLocked();});
+        m_state.fetch_sub(sleeper);
+        TTL_CONTENTION_SCOPE(notified_in_time ? m_contention.addWrite(Contention::Clock::now() - start) : m_contention.addTimeout();)
+        return notified_in_time;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Flare::setSpinCount(const Sti_t spin_count)
+    {
+        m_spin_count.store(spin_count, std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t Flare::getSpinCount() const
+    {
+        return m_spin_count.load(std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Flare::setName(const std::string &name)
+    {
+        TTL_CONTENTION_SCOPE(m_contention.setName(name);)
+        static_cast<void>(name);
     }
 
 } // Namespace ttl
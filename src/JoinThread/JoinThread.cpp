@@ -20,6 +20,7 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 
 // Headers
 #include "JoinThread/JoinThread.hpp"
+#include <utility>
 
 
 namespace ttl
@@ -31,6 +32,17 @@ namespace ttl
 //    std::thread()
 //    {}
 
+    ////////////////////////////////////////////////////////////
+    JoinThread &JoinThread::operator=(JoinThread &&thread)
+    {
+        if (this->joinable())
+        {
+            this->join();
+        }
+        std::thread::operator=(std::move(thread));
+        return *this;
+    }
+
     ////////////////////////////////////////////////////////////
     JoinThread::~JoinThread()
     {
@@ -0,0 +1,54 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Headers
+#include "Ring/RingSignal.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    RingSignal::RingSignal(const bool blocking)
+    :
+        m_blocking(blocking),
+        m_waiters(0)
+    {}
+
+    ////////////////////////////////////////////////////////////
+    void RingSignal::notify()
+    {
+        if (m_blocking)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst); // The progress is visible to anyone registered after this
+            if (m_waiters->load(std::memory_order_relaxed) != 0)
+            {
+                m_flare.notify();
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool RingSignal::isBlocking() const
+    {
+        return m_blocking;
+    }
+
+} // Namespace ttl
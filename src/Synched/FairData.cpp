@@ -0,0 +1,145 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Headers
+#include "Synched/FairData.hpp"
+#include <algorithm>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    FairData::FairData()
+    :
+        m_next_ticket(0),
+        m_serving(0),
+        m_readers(0),
+        m_writer(false)
+    {}
+
+    ////////////////////////////////////////////////////////////
+    Sti_t FairData::lockShared()
+    {
+        std::unique_lock<std::mutex> lock(m_mx);
+        const Sti_t ticket = m_next_ticket++;
+        m_cndvar.wait(lock, [this, ticket]() -> bool {return m_serving == ticket && m_writer == false;});
+        ++m_readers;
+        this->serveNext(); // The next arrival may join us if it reads
+        lock.unlock();
+        m_cndvar.notify_all();
+        return 0;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool FairData::tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mx);
+        const Sti_t ticket = m_next_ticket++;
+        if (m_cndvar.wait_for(lock, timeout, [this, ticket]() -> bool {return m_serving == ticket && m_writer == false;}) == false)
+        {
+            this->abandon(ticket);
+            return false;
+        }
+        ++m_readers;
+        this->serveNext();
+        lock.unlock();
+        m_cndvar.notify_all();
+        token = 0;
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void FairData::unlockShared(const Sti_t)
+    {
+        std::lock_guard<std::mutex> lock(m_mx);
+        if (--m_readers == 0)
+        {
+            m_cndvar.notify_all();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void FairData::lock()
+    {
+        std::unique_lock<std::mutex> lock(m_mx);
+        const Sti_t ticket = m_next_ticket++;
+        m_cndvar.wait(lock, [this, ticket]() -> bool {return m_serving == ticket && m_writer == false && m_readers == 0;});
+        m_writer = true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool FairData::tryLock(const std::chrono::nanoseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mx);
+        const Sti_t ticket = m_next_ticket++;
+        if (m_cndvar.wait_for(lock, timeout, [this, ticket]() -> bool {return m_serving == ticket && m_writer == false && m_readers == 0;}) == false)
+        {
+            this->abandon(ticket);
+            return false;
+        }
+        m_writer = true;
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void FairData::unlock()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mx);
+            m_writer = false;
+            this->serveNext();
+        }
+        m_cndvar.notify_all();
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t FairData::getReaderCount() const
+    {
+        return m_readers;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void FairData::serveNext()
+    {
+        ++m_serving;
+        std::vector<Sti_t>::iterator it;
+        while ((it = std::find(m_abandoned.begin(), m_abandoned.end(), m_serving)) != m_abandoned.end())
+        {
+            m_abandoned.erase(it);
+            ++m_serving;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void FairData::abandon(const Sti_t ticket)
+    {
+        if (m_serving == ticket) // Our turn came but the lock did not free up in time
+        {
+            this->serveNext();
+            m_cndvar.notify_all();
+        }
+        else
+        {
+            m_abandoned.push_back(ticket);
+        }
+    }
+
+} // Namespace ttl
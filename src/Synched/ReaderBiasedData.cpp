@@ -0,0 +1,179 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Headers
+#include "Synched/ReaderBiasedData.hpp"
+#include "Sleep/Sleep.hpp"
+#include <algorithm>
+#include <thread>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    ReaderBiasedData::ReaderBiasedData()
+    :
+        m_slots(std::max(1u, std::thread::hardware_concurrency())),
+        m_readers(new Padded<std::atomic<Sti_t>>[m_slots]),
+        m_writer(false)
+    {
+        for (Sti_t i = 0; i < m_slots; ++i)
+        {
+            *m_readers[i] = 0;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t ReaderBiasedData::lockShared()
+    {
+        const Sti_t slot = getThreadIndex() % m_slots;
+        std::atomic<Sti_t> &readers = *m_readers[slot];
+        for (;;)
+        {
+            readers.fetch_add(1);
+            if (m_writer.load() == false) // Seen by the writer if it sets m_writer after our check
+            {
+                return slot;
+            }
+            this->unlockShared(slot);
+            std::unique_lock<std::mutex> lock(m_mx);
+            m_cndvar.wait(lock, [this]() -> bool {return m_writer == false;});
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool ReaderBiasedData::tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout)
+    {
+        const std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::now() + timeout);
+        const Sti_t slot = getThreadIndex() % m_slots;
+        std::atomic<Sti_t> &readers = *m_readers[slot];
+        for (;;)
+        {
+            readers.fetch_add(1);
+            if (m_writer.load() == false)
+            {
+                token = slot;
+                return true;
+            }
+            this->unlockShared(slot);
+            std::unique_lock<std::mutex> lock(m_mx);
+            if (m_cndvar.wait_until(lock, deadline, [this]() -> bool {return m_writer == false;}) == false)
+            {
+                return false;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void ReaderBiasedData::unlockShared(const Sti_t token)
+    {
+        // The writer sets m_writer before it reads the counter, so one of us sees the other
+        if (m_readers[token]->fetch_sub(1) == 1 && m_writer.load())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mx);
+            }
+            m_cndvar.notify_all();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void ReaderBiasedData::lock()
+    {
+        m_writer_mutex.lock();
+        m_writer = true;
+        for (Sti_t i = 0; i < m_slots; ++i)
+        {
+            std::atomic<Sti_t> &readers = *m_readers[i];
+            for (Sti_t spins = 0; readers.load() != 0 && spins < 100; ++spins)
+            {
+                cpuRelax();
+            }
+            if (readers.load() != 0)
+            {
+                // The reader that empties the counter wakes us
+                std::unique_lock<std::mutex> lock(m_mx);
+                m_cndvar.wait(lock, [&readers]() -> bool {return readers.load() == 0;});
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool ReaderBiasedData::tryLock(const std::chrono::nanoseconds timeout)
+    {
+        const std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::now() + timeout);
+        if (m_writer_mutex.try_lock_until(deadline) == false)
+        {
+            return false;
+        }
+        m_writer = true;
+        for (Sti_t i = 0; i < m_slots; ++i)
+        {
+            std::atomic<Sti_t> &readers = *m_readers[i];
+            for (Sti_t spins = 0; readers.load() != 0 && spins < 100; ++spins)
+            {
+                cpuRelax();
+            }
+            if (readers.load() != 0)
+            {
+                std::unique_lock<std::mutex> lock(m_mx);
+                if (m_cndvar.wait_until(lock, deadline, [&readers]() -> bool {return readers.load() == 0;}) == false)
+                {
+                    lock.unlock();
+                    this->unlock();
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void ReaderBiasedData::unlock()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mx);
+            m_writer = false;
+        }
+        m_cndvar.notify_all();
+        m_writer_mutex.unlock();
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t ReaderBiasedData::getThreadIndex()
+    {
+        static std::atomic<Sti_t> next_index(0);
+        static thread_local const Sti_t index = next_index++;
+        return index;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t ReaderBiasedData::getReaderCount() const
+    {
+        Sti_t readers = 0;
+        for (Sti_t i = 0; i < m_slots; ++i)
+        {
+            readers += m_readers[i]->load(std::memory_order_relaxed);
+        }
+        return readers;
+    }
+
+} // Namespace ttl
@@ -0,0 +1,174 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Headers
+#include "Synched/ReaderPreferringData.hpp"
+#include "Sleep/Sleep.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    ReaderPreferringData::ReaderPreferringData()
+    :
+        m_state(0),
+        m_sleepers(0)
+    {}
+
+    ////////////////////////////////////////////////////////////
+    Sti_t ReaderPreferringData::lockShared()
+    {
+        Sti_t state = m_state.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (state == writer)
+            {
+                this->waitUntil([this]() -> bool {return m_state != writer;});
+                state = m_state.load(std::memory_order_relaxed);
+            }
+            else if (m_state.compare_exchange_weak(state, state + 1))
+            {
+                return 0;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool ReaderPreferringData::tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout)
+    {
+        const std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::now() + timeout);
+        Sti_t state = m_state.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (state == writer)
+            {
+                if (this->waitUntil([this]() -> bool {return m_state != writer;}, deadline) == false)
+                {
+                    return false;
+                }
+                state = m_state.load(std::memory_order_relaxed);
+            }
+            else if (m_state.compare_exchange_weak(state, state + 1))
+            {
+                token = 0;
+                return true;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void ReaderPreferringData::unlockShared(const Sti_t)
+    {
+        if (m_state.fetch_sub(1) == 1)
+        {
+            this->wake();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void ReaderPreferringData::lock()
+    {
+        Sti_t idle = 0;
+        while (m_state.compare_exchange_strong(idle, writer) == false)
+        {
+            this->waitUntil([this]() -> bool {return m_state == 0;});
+            idle = 0;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool ReaderPreferringData::tryLock(const std::chrono::nanoseconds timeout)
+    {
+        const std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::now() + timeout);
+        Sti_t idle = 0;
+        while (m_state.compare_exchange_strong(idle, writer) == false)
+        {
+            if (this->waitUntil([this]() -> bool {return m_state == 0;}, deadline) == false)
+            {
+                return false;
+            }
+            idle = 0;
+        }
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void ReaderPreferringData::unlock()
+    {
+        m_state = 0;
+        this->wake();
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t ReaderPreferringData::getReaderCount() const
+    {
+        const Sti_t state = m_state;
+        return state == writer ? 0 : state;
+    }
+
+    ////////////////////////////////////////////////////////////
+    template <typename PREDICATE>
+    void ReaderPreferringData::waitUntil(PREDICATE predicate)
+    {
+        for (Sti_t i = spin_count; i > 0; --i)
+        {
+            if (predicate())
+            {
+                return;
+            }
+            cpuRelax();
+        }
+        std::unique_lock<std::mutex> lock(m_mx);
+        ++m_sleepers; // Seen by any thread that changes the state after our check below
+        m_cndvar.wait(lock, predicate);
+        --m_sleepers;
+    }
+
+    ////////////////////////////////////////////////////////////
+    template <typename PREDICATE>
+    bool ReaderPreferringData::waitUntil(PREDICATE predicate, const std::chrono::steady_clock::time_point deadline)
+    {
+        for (Sti_t i = spin_count; i > 0; --i)
+        {
+            if (predicate())
+            {
+                return true;
+            }
+            cpuRelax();
+        }
+        std::unique_lock<std::mutex> lock(m_mx);
+        ++m_sleepers;
+        const bool satisfied = m_cndvar.wait_until(lock, deadline, predicate);
+        --m_sleepers;
+        return satisfied;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void ReaderPreferringData::wake()
+    {
+        if (m_sleepers != 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mx);
+            m_cndvar.notify_all();
+        }
+    }
+
+} // Namespace ttl
@@ -0,0 +1,85 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Headers
+#include "Synched/SequenceData.hpp"
+#include "Sleep/Sleep.hpp"
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    SequenceData::SequenceData()
+    :
+        m_sequence(0)
+    {}
+
+    ////////////////////////////////////////////////////////////
+    Sti_t SequenceData::beginRead() const
+    {
+        Sti_t sequence = m_sequence.load(std::memory_order_acquire);
+        while (sequence % 2 != 0)
+        {
+            cpuRelax();
+            sequence = m_sequence.load(std::memory_order_acquire);
+        }
+        return sequence;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool SequenceData::endRead(const Sti_t sequence) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire); // Orders the copy before the check
+        return m_sequence.load(std::memory_order_relaxed) == sequence;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SequenceData::lock()
+    {
+        m_writer_mutex.lock();
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SequenceData::unlock()
+    {
+        m_writer_mutex.unlock();
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SequenceData::beginWrite()
+    {
+        m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release); // Orders the odd sequence before the writes
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SequenceData::endWrite()
+    {
+        m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t SequenceData::getReaderCount() const
+    {
+        return 0;
+    }
+
+} // Namespace ttl
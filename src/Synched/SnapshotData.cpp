@@ -0,0 +1,176 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Headers
+#include "Synched/SnapshotData.hpp"
+#include "Synched/ReaderBiasedData.hpp"
+#include <algorithm>
+#include <thread>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    SnapshotData::SnapshotData()
+    :
+        m_slots(std::max(1u, std::thread::hardware_concurrency())),
+        m_readers(new Padded<std::atomic<Sti_t>>[2 * m_slots]),
+        m_phase(0),
+        m_retired_count(0),
+        m_retired(nullptr),
+        m_grace(nullptr),
+        m_second_flip(false),
+        m_reclaiming(false),
+        m_again(false)
+    {
+        for (Sti_t i = 0; i < 2 * m_slots; ++i)
+        {
+            *m_readers[i] = 0;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    SnapshotData::~SnapshotData()
+    {
+        destroy(m_grace);
+        destroy(m_retired.load());
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t SnapshotData::enter()
+    {
+        const Sti_t token = ReaderBiasedData::getThreadIndex() % m_slots * 2 + m_phase.load();
+        m_readers[token]->fetch_add(1); // Precedes the reader's load of the current version
+        return token;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SnapshotData::leave(const Sti_t token)
+    {
+        // A reclaimer that saw this reader reads m_retired_count after it, so one of us moves on
+        if (m_readers[token]->fetch_sub(1) == 1 && m_retired_count.load() != 0)
+        {
+            this->reclaim();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t SnapshotData::getReaderCount() const
+    {
+        Sti_t readers = 0;
+        for (Sti_t i = 0; i < 2 * m_slots; ++i)
+        {
+            readers += m_readers[i]->load(std::memory_order_relaxed);
+        }
+        return readers;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t SnapshotData::getRetiredCount() const
+    {
+        return m_retired_count.load(std::memory_order_relaxed);
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SnapshotData::retire(void *data, void (*destroy)(void *))
+    {
+        ++m_retired_count;
+        Retired *retired = new Retired{data, destroy, m_retired.load(std::memory_order_relaxed)};
+        while (m_retired.compare_exchange_weak(retired->next, retired) == false);
+        this->reclaim();
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SnapshotData::reclaim()
+    {
+        // Whoever finds m_reclaiming held leaves m_again for its holder, who checks it after letting go
+        m_again = true;
+        while (m_again.load() && m_reclaiming.exchange(true) == false)
+        {
+            m_again = false;
+            this->advance();
+            m_reclaiming = false;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SnapshotData::advance()
+    {
+        for (;;)
+        {
+            if (m_grace == nullptr)
+            {
+                // Earlier readers may count in either phase; new
+                // readers stay out of the phase that is drained
+                m_grace = m_retired.exchange(nullptr);
+                if (m_grace == nullptr)
+                {
+                    return;
+                }
+                m_second_flip = false;
+                m_phase = m_phase.load() ^ 1;
+            }
+            if (this->isDrained(m_phase.load() ^ 1) == false)
+            {
+                return; // The reader that drains it calls reclaim
+            }
+            if (m_second_flip == false)
+            {
+                m_second_flip = true;
+                m_phase = m_phase.load() ^ 1;
+            }
+            else
+            {
+                Retired *grace = m_grace;
+                m_grace = nullptr;
+                m_retired_count -= destroy(grace);
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool SnapshotData::isDrained(const Sti_t phase) const
+    {
+        for (Sti_t slot = 0; slot < m_slots; ++slot)
+        {
+            if (m_readers[slot * 2 + phase]->load() != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t SnapshotData::destroy(Retired *retired)
+    {
+        Sti_t count = 0;
+        for (; retired != nullptr; ++count)
+        {
+            Retired *next = retired->next;
+            retired->destroy(retired->data);
+            delete retired;
+            retired = next;
+        }
+        return count;
+    }
+
+} // Namespace ttl
@@ -34,4 +34,73 @@ namespace ttl
         writer_activation(true), readers(0)
         {}
 
+    ////////////////////////////////////////////////////////////
+    Sti_t SynchedData::lockShared()
+    {
+        // Later readers wait here until the first has taken the data from the writers
+        std::lock_guard<std::timed_mutex> lock(entry_mutex);
+        if (readers.fetch_add(1) == 0)
+            writer_activation.wait();
+        return 0;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool SynchedData::tryLockShared(Sti_t &token, const std::chrono::nanoseconds timeout)
+    {
+        const std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::now() + timeout);
+        std::unique_lock<std::timed_mutex> lock(entry_mutex, deadline);
+        if (lock.owns_lock() == false)
+            return false;
+        if (readers.fetch_add(1) == 0 && writer_activation.waitFor(deadline - std::chrono::steady_clock::now()) == false)
+        {
+            readers.fetch_sub(1); // Later readers are still held back by the entry mutex
+            return false;
+        }
+        token = 0;
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SynchedData::unlockShared(const Sti_t)
+    {
+        if (readers.fetch_sub(1) == 1)
+        {
+            writer_activation.notify();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SynchedData::lock()
+    {
+        entry_mutex.lock();
+        writer_activation.wait();
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool SynchedData::tryLock(const std::chrono::nanoseconds timeout)
+    {
+        const std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::now() + timeout);
+        if (entry_mutex.try_lock_until(deadline) == false)
+            return false;
+        if (writer_activation.waitFor(deadline - std::chrono::steady_clock::now()) == false)
+        {
+            entry_mutex.unlock();
+            return false;
+        }
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void SynchedData::unlock()
+    {
+        entry_mutex.unlock();
+        writer_activation.notify();
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t SynchedData::getReaderCount() const
+    {
+        return readers.load();
+    }
+
 } // Namespace ttl
@@ -0,0 +1,202 @@
+/*
+Copyright 2013, 2014 Kevin Robert Stravers
+
+This file is part of TTL.
+
+TTL is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+TTL is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with TTL.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+// Headers
+#include "TaskGraph/TaskGraph.hpp"
+#include <stdexcept>
+
+
+namespace ttl
+{
+
+    ////////////////////////////////////////////////////////////
+    TaskGraph::Node::Node(std::function<void()> function)
+    :
+        function(std::move(function)),
+        predecessors(0),
+        pending(0)
+    {}
+
+    ////////////////////////////////////////////////////////////
+    TaskGraph::TaskGraph()
+    :
+        m_remaining(0),
+        m_acyclic(true)
+    {}
+
+    ////////////////////////////////////////////////////////////
+    void TaskGraph::precede(const Task before, const Task after)
+    {
+        m_tasks[before].successors.push_back(after);
+        ++m_tasks[after].predecessors;
+        m_acyclic = false;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void TaskGraph::run(BatchWorker &pool)
+    {
+        this->checkAcyclic();
+        if (m_tasks.empty())
+        {
+            return;
+        }
+
+        for (Node &node : m_tasks)
+        {
+            node.pending = node.predecessors;
+        }
+        if (pool.isWorkerThread())
+        {
+            this->executeInline();
+            return;
+        }
+        m_remaining = m_tasks.size();
+        m_done.setSpinCount(pool.getSpinCount());
+
+        for (Task task(0); task < m_tasks.size(); ++task)
+        {
+            if (m_tasks[task].predecessors == 0)
+            {
+                pool.issueWork([this, &pool, task]() {this->execute(pool, task);});
+            }
+        }
+
+        m_done.wait();
+    }
+
+    ////////////////////////////////////////////////////////////
+    Sti_t TaskGraph::getTaskCount() const
+    {
+        return m_tasks.size();
+    }
+
+    ////////////////////////////////////////////////////////////
+    void TaskGraph::clear()
+    {
+        m_tasks.clear();
+        m_acyclic = true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void TaskGraph::execute(BatchWorker &pool, Task task)
+    {
+        for (;;)
+        {
+            Node &node = m_tasks[task];
+            node.function();
+
+            // Continue with the first successor that became ready, hand out the rest
+            bool next = false;
+            for (const Task successor : node.successors)
+            {
+                if (m_tasks[successor].pending.fetch_sub(1) == 1)
+                {
+                    if (next)
+                    {
+                        pool.issueWork([this, &pool, successor]() {this->execute(pool, successor);});
+                    }
+                    else
+                    {
+                        next = true;
+                        task = successor;
+                    }
+                }
+            }
+
+            if (m_remaining.fetch_sub(1) == 1)
+            {
+                m_done.notify(); // Last access, run may return and the graph go away
+                return;
+            }
+            if (next == false)
+            {
+                return;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void TaskGraph::executeInline()
+    {
+        std::vector<Task> ready;
+        for (Task task(0); task < m_tasks.size(); ++task)
+        {
+            if (m_tasks[task].predecessors == 0)
+            {
+                ready.push_back(task);
+            }
+        }
+        while (ready.empty() == false)
+        {
+            Node &node = m_tasks[ready.back()];
+            ready.pop_back();
+            node.function();
+            for (const Task successor : node.successors)
+            {
+                if (--m_tasks[successor].pending == 0)
+                {
+                    ready.push_back(successor);
+                }
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void TaskGraph::checkAcyclic()
+    {
+        if (m_acyclic)
+        {
+            return;
+        }
+
+        std::vector<Sti_t> pending;
+        std::vector<Task> ready;
+        for (Task task(0); task < m_tasks.size(); ++task)
+        {
+            pending.push_back(m_tasks[task].predecessors);
+            if (pending.back() == 0)
+            {
+                ready.push_back(task);
+            }
+        }
+
+        Sti_t visited(0);
+        while (ready.empty() == false)
+        {
+            const Task task = ready.back();
+            ready.pop_back();
+            ++visited;
+            for (const Task successor : m_tasks[task].successors)
+            {
+                if (--pending[successor] == 0)
+                {
+                    ready.push_back(successor);
+                }
+            }
+        }
+
+        if (visited != m_tasks.size())
+        {
+            throw std::invalid_argument("TaskGraph::run, the tasks depend on each other in a cycle");
+        }
+        m_acyclic = true;
+    }
+
+} // Namespace ttl
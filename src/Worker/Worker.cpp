@@ -21,6 +21,10 @@ along with TTL.  If not, see <http://www.gnu.org/licenses/>.
 // Headers
 #include "Worker/Worker.hpp"
 #include <iostream>
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
 
 
 namespace ttl
@@ -29,26 +33,153 @@ namespace ttl
     ////////////////////////////////////////////////////////////
     Worker::Worker()
     :
+        m_idle_timeout(0),
+        m_running(true),
+        m_state(AWAKE),
         m_thread(&Worker::work, this)
     {}
 
+    ////////////////////////////////////////////////////////////
+    Worker::Worker(Job on_start, bool start)
+    :
+        m_on_start(std::move(on_start)),
+        m_idle_timeout(0),
+        m_running(true),
+        m_state(start ? AWAKE : RETIRED)
+    {
+        if (start)
+        {
+            m_thread = JoinThread(&Worker::work, this);
+        }
+    }
+
     ////////////////////////////////////////////////////////////
     Worker::~Worker()
     {
-        m_work = nullptr;
+        m_running = false;
         m_work_available.notify();
     }
 
+    ////////////////////////////////////////////////////////////
+    bool Worker::tryIssueWork(Job &job)
+    {
+        if (m_queue.push(std::move(job)) == false)
+        {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_state.load() != AWAKE)
+        {
+            const Sti_t state = m_state.exchange(AWAKE);
+            if (state == SLEEPING)
+            {
+                m_work_available.notify();
+            }
+            else if (state == RETIRED)
+            {
+                this->restart();
+            }
+        }
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Worker::setSpinCount(const Sti_t spin_count)
+    {
+        m_work_available.setSpinCount(spin_count);
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Worker::setIdleTimeout(const std::chrono::nanoseconds timeout)
+    {
+        m_idle_timeout = timeout.count();
+        m_work_available.notify(); // A sleeping worker starts over with the new timeout
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool Worker::isRetired() const
+    {
+        return m_state == RETIRED;
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool Worker::setAffinity(const std::vector<Sti_t> &cpus)
+    {
+        std::lock_guard<std::mutex> lock(m_thread_mutex);
+        m_cpus = cpus;
+        if (m_state == RETIRED)
+        {
+            return true; // Applied by restart
+        }
+        return this->applyAffinity();
+    }
+
+    ////////////////////////////////////////////////////////////
+    void Worker::restart()
+    {
+        std::lock_guard<std::mutex> lock(m_thread_mutex);
+        m_thread = JoinThread(&Worker::work, this); // Joins the thread that retired
+        if (m_cpus.empty() == false)
+        {
+            this->applyAffinity();
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    bool Worker::applyAffinity()
+    {
+        #ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (const Sti_t cpu : m_cpus)
+            {
+                if (cpu >= CPU_SETSIZE)
+                {
+                    return false;
+                }
+                CPU_SET(cpu, &set);
+            }
+            return m_cpus.empty() == false && m_thread.joinable() && pthread_setaffinity_np(m_thread.native_handle(), sizeof(set), &set) == 0;
+        #else
+            return false;
+        #endif
+    }
+
     ////////////////////////////////////////////////////////////
     void Worker::work()
     {
+        if (m_on_start)
+        {
+            m_on_start();
+        }
+        Job function;
         top:
-            m_work_available.wait();
-            std::function<void()> function = m_work;
-            if (function)
+            while (m_queue.pop(function))
+            {
                 function();
-            else
-                return;
+                function = nullptr;
+            }
+            m_state = SLEEPING;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_queue.isEmpty())
+            {
+                if (m_running == false)
+                    return;
+                const std::chrono::nanoseconds::rep timeout = m_idle_timeout;
+                if (timeout == 0)
+                {
+                    m_work_available.wait();
+                }
+                else if (m_work_available.waitFor(std::chrono::nanoseconds(timeout)) == false)
+                {
+                    Sti_t sleeping = SLEEPING;
+                    if (m_state.compare_exchange_strong(sleeping, RETIRED))
+                    {
+                        return; // The next work issued starts a new thread
+                    }
+                }
+            }
+            m_state = AWAKE;
         goto top;
     }
 
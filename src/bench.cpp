@@ -0,0 +1,810 @@
+#include "TTL/TTL.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+
+    ////////////////////////////////////////////////////////////
+    ttl::Sti_t getHelperCount()
+    {
+        return std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkBatchWorkerSchedules()
+    {
+        std::vector<float> v(1 << 24);
+        ttl::BatchWorker w(getHelperCount());
+
+        for (auto schedule : {ttl::BatchWorker::Schedule::Strided, ttl::BatchWorker::Schedule::Contiguous})
+        {
+            w.setSchedule(schedule);
+            ttl::Benchmark ben(schedule == ttl::BatchWorker::Schedule::Strided ? "fer strided, 16M floats" : "fer contiguous, 16M floats", 10);
+            ben.run
+            (
+                [&w, &v]()
+                {
+                    w.fer(v.begin(), v.end(), [](float &f){f = 1.5f;});
+                }
+            );
+            std::cout << ben;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkBatchWorkerSmallRanges()
+    {
+        ttl::BatchWorker w(getHelperCount());
+        w.setSpinCount(1000);
+        for (ttl::Sti_t size = 16; size <= (1 << 20); size *= 4)
+        {
+            std::vector<float> v(size);
+
+            ttl::Benchmark serial("for loop, " + std::to_string(size) + " floats", 20);
+            serial.run
+            (
+                [&v]()
+                {
+                    for (float &f : v)
+                    {
+                        f += 1.f;
+                    }
+                }
+            );
+            std::cout << serial;
+
+            for (ttl::Sti_t minimum : {0, 4096})
+            {
+                w.setMinimumBlockSize(minimum);
+                ttl::Benchmark parallel("fer, minimum block " + std::to_string(minimum) + ", " + std::to_string(size) + " floats", 20);
+                parallel.run
+                (
+                    [&w, &v]()
+                    {
+                        w.fer(v.begin(), v.end(), [](float &f){f += 1.f;});
+                    }
+                );
+                std::cout << parallel;
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkBatchWorkerIrregular()
+    {
+        std::vector<double> v(1 << 16);
+        ttl::BatchWorker w(getHelperCount());
+
+        const char *names[] = {"fer strided, heavy-tailed cost", "fer contiguous, heavy-tailed cost", "fer stealing, heavy-tailed cost"};
+        const ttl::BatchWorker::Schedule schedules[] = {ttl::BatchWorker::Schedule::Strided, ttl::BatchWorker::Schedule::Contiguous, ttl::BatchWorker::Schedule::Stealing};
+        for (ttl::Sti_t i = 0; i < 3; ++i)
+        {
+            w.setSchedule(schedules[i]);
+            ttl::Benchmark ben(names[i], 10);
+            ben.run
+            (
+                [&w, &v]()
+                {
+                    w.fer
+                    (
+                        ttl::Sit(0), ttl::Sit(v.size()), [&v](std::size_t n)
+                        {
+                            // The first 1% of the elements cost 1000 times more
+                            const std::size_t cost = n < v.size() / 100 ? 1000 : 1;
+                            double x = 0;
+                            for (std::size_t k = 0; k < cost; ++k)
+                            {
+                                x += std::sqrt(static_cast<double>(n + k));
+                            }
+                            v[n] = x;
+                        }
+                    );
+                }
+            );
+            std::cout << ben;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkMpscQueue()
+    {
+        const ttl::Sti_t items = 1 << 20;
+        for (ttl::Sti_t producers : {1, 4, 16})
+        {
+            ttl::MpscQueue<ttl::Sti_t> queue(1024);
+            ttl::Benchmark ben("MpscQueue, 1M items from " + std::to_string(producers) + " producers", 1);
+            ben.run
+            (
+                [&queue, producers, items]()
+                {
+                    std::vector<std::thread> threads;
+                    for (ttl::Sti_t p = 0; p < producers; ++p)
+                    {
+                        threads.emplace_back
+                        (
+                            [&queue, producers, items]()
+                            {
+                                for (ttl::Sti_t i = 0; i < items / producers; ++i)
+                                {
+                                    while (queue.push(i) == false)
+                                    {
+                                        std::this_thread::yield();
+                                    }
+                                }
+                            }
+                        );
+                    }
+                    ttl::Sti_t value;
+                    for (ttl::Sti_t popped = 0; popped < items / producers * producers;)
+                    {
+                        if (queue.pop(value))
+                        {
+                            ++popped;
+                        }
+                        else
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                    for (std::thread &thread : threads)
+                    {
+                        thread.join();
+                    }
+                }
+            );
+            std::cout << ben;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkFlareLatency()
+    {
+        for (ttl::Sti_t spin_count : {0, 1 << 10, 1 << 14})
+        {
+            ttl::Flare ping(false, spin_count), pong(false, spin_count);
+            const ttl::Sti_t round_trips = 10000;
+            ttl::JoinThread echo
+            (
+                [&ping, &pong, round_trips]()
+                {
+                    for (ttl::Sti_t i = 0; i < round_trips; ++i)
+                    {
+                        ping.wait();
+                        pong.notify();
+                    }
+                }
+            );
+            ttl::Benchmark ben("Flare round trip, spin count " + std::to_string(spin_count), round_trips);
+            ben.run
+            (
+                [&ping, &pong]()
+                {
+                    ping.notify();
+                    pong.wait();
+                }
+            );
+            std::cout << ben;
+        }
+
+        std::vector<float> v(256);
+        ttl::BatchWorker w(getHelperCount());
+        for (ttl::Sti_t spin_count : {0, 1 << 10, 1 << 14})
+        {
+            w.setSpinCount(spin_count);
+            ttl::Benchmark ben("fer over 256 floats, spin count " + std::to_string(spin_count), 10000);
+            ben.run
+            (
+                [&w, &v]()
+                {
+                    w.fer(v.begin(), v.end(), [](float &f){f += 1.f;});
+                }
+            );
+            std::cout << ben;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkReduce()
+    {
+        std::vector<double> v(1 << 24, 0.25);
+        ttl::BatchWorker w(getHelperCount());
+        double sum = 0;
+
+        ttl::Benchmark serial("std::accumulate, 16M doubles", 10);
+        serial.run
+        (
+            [&v, &sum]()
+            {
+                sum += std::accumulate(v.begin(), v.end(), 0.0);
+            }
+        );
+        std::cout << serial;
+
+        ttl::Benchmark parallel("BatchWorker::reduce, 16M doubles", 10);
+        parallel.run
+        (
+            [&w, &v, &sum]()
+            {
+                sum += w.reduce(v.begin(), v.end(), 0.0, std::plus<double>());
+            }
+        );
+        std::cout << parallel;
+
+        ttl::Benchmark transformed("BatchWorker::transformReduce, sum of squares of 16M doubles", 10);
+        transformed.run
+        (
+            [&w, &v, &sum]()
+            {
+                sum += w.transformReduce(v.begin(), v.end(), 0.0, std::plus<double>(), [](double d){return d * d;});
+            }
+        );
+        std::cout << transformed << "(checksum " << sum << ")" << std::endl;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkScan()
+    {
+        ttl::BatchWorker w(getHelperCount());
+        for (ttl::Sti_t size : {1000000, 10000000, 100000000})
+        {
+            std::vector<std::uint32_t> v(size, 1);
+
+            ttl::Benchmark serial("std::partial_sum, " + std::to_string(size) + " integers", 3);
+            serial.run
+            (
+                [&v]()
+                {
+                    std::partial_sum(v.begin(), v.end(), v.begin());
+                }
+            );
+            std::cout << serial;
+
+            ttl::Benchmark parallel("BatchWorker::inclusiveScan, " + std::to_string(size) + " integers", 3);
+            parallel.run
+            (
+                [&w, &v]()
+                {
+                    w.inclusiveScan(v.begin(), v.end(), v.begin(), std::plus<std::uint32_t>());
+                }
+            );
+            std::cout << parallel;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkSort()
+    {
+        ttl::BatchWorker w(getHelperCount());
+        const ttl::Sti_t size = 1 << 23;
+        std::vector<std::uint32_t> random(size), presorted(size), duplicates(size);
+        for (ttl::Sti_t i = 0; i < size; ++i)
+        {
+            random[i] = static_cast<std::uint32_t>(i * 2654435761u);
+            presorted[i] = static_cast<std::uint32_t>(i);
+            duplicates[i] = random[i] % 16;
+        }
+
+        const std::pair<const char *, const std::vector<std::uint32_t> *> inputs[] = {{"random", &random}, {"presorted", &presorted}, {"16 distinct", &duplicates}};
+        for (const auto &input : inputs)
+        {
+            std::vector<std::uint32_t> v;
+
+            ttl::Benchmark serial(std::string("std::sort, 8M integers, ") + input.first, 5);
+            serial.run
+            (
+                [&v, &input]()
+                {
+                    v = *input.second;
+                    std::sort(v.begin(), v.end());
+                }
+            );
+            std::cout << serial;
+
+            ttl::Benchmark parallel(std::string("BatchWorker::sort, 8M integers, ") + input.first, 5);
+            parallel.run
+            (
+                [&w, &v, &input]()
+                {
+                    v = *input.second;
+                    w.sort(v.begin(), v.end());
+                }
+            );
+            std::cout << parallel;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkFind()
+    {
+        ttl::BatchWorker w(getHelperCount());
+        std::vector<std::uint32_t> v(1 << 26);
+        std::iota(v.begin(), v.end(), 0u);
+
+        for (std::uint32_t target : {1u << 10, 1u << 20, (1u << 26) - 1})
+        {
+            auto is_target = [target](std::uint32_t n){return n == target;};
+            std::vector<std::uint32_t>::iterator match;
+
+            ttl::Benchmark serial("std::find_if, match at " + std::to_string(target) + " of 64M", 5);
+            serial.run
+            (
+                [&v, &match, &is_target]()
+                {
+                    match = std::find_if(v.begin(), v.end(), is_target);
+                }
+            );
+            std::cout << serial;
+
+            ttl::Benchmark parallel("BatchWorker::findIf, match at " + std::to_string(target) + " of 64M", 5);
+            parallel.run
+            (
+                [&w, &v, &match, &is_target]()
+                {
+                    match = w.findIf(v.begin(), v.end(), is_target);
+                }
+            );
+            std::cout << parallel;
+
+            ttl::Benchmark full("BatchWorker::fer without early exit, 64M", 5);
+            full.run
+            (
+                [&w, &v, &is_target]()
+                {
+                    std::atomic<bool> any(false);
+                    w.fer(v.begin(), v.end(), [&any, &is_target](std::uint32_t n){if (is_target(n)) any = true;});
+                }
+            );
+            std::cout << full << "(match " << (match - v.begin()) << ")" << std::endl;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkBarrier()
+    {
+        const int phases = 1000;
+        for (ttl::Sti_t threads = 2; threads <= 64; threads *= 2)
+        {
+            ttl::BatchWorker w(threads - 1);
+            w.setSpinCount(1000);
+
+            ttl::Benchmark barrier(std::to_string(phases) + " barrier phases, " + std::to_string(threads) + " threads", 5);
+            barrier.run
+            (
+                [&w, phases]()
+                {
+                    w.parallel
+                    (
+                        [phases](ttl::Sti_t, ttl::Sti_t, ttl::Barrier &barrier)
+                        {
+                            for (int phase = 0; phase < phases; ++phase)
+                            {
+                                barrier.wait();
+                            }
+                        }
+                    );
+                }
+            );
+            std::cout << barrier;
+
+            std::vector<ttl::Sti_t> indices(threads);
+            ttl::Benchmark dispatch(std::to_string(phases) + " fer calls, " + std::to_string(threads) + " threads", 5);
+            dispatch.run
+            (
+                [&w, &indices, phases]()
+                {
+                    for (int phase = 0; phase < phases; ++phase)
+                    {
+                        w.fer(indices.begin(), indices.end(), [](ttl::Sti_t){});
+                    }
+                }
+            );
+            std::cout << dispatch;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    template <typename POLICY>
+    void benchmarkSynchedReads(const char *policy)
+    {
+        ttl::Synched<std::vector<int>, POLICY> config(std::vector<int>(64, 1));
+        for (ttl::Sti_t threads = 1; threads <= 32; threads *= 2)
+        {
+            ttl::Benchmark ben(std::string("Synched reads, ") + policy + ", " + std::to_string(threads) + " threads x 100k", 3);
+            ben.run
+            (
+                [&config, threads]()
+                {
+                    std::vector<std::thread> readers;
+                    for (ttl::Sti_t i = 0; i < threads; ++i)
+                    {
+                        readers.emplace_back
+                        (
+                            [&config]()
+                            {
+                                long sum = 0;
+                                for (int read = 0; read < 100000; ++read)
+                                {
+                                    sum += (*config.getReadAccess())[read % 64];
+                                }
+                                if (sum == 0)
+                                {
+                                    std::cout << "unreachable" << std::endl;
+                                }
+                            }
+                        );
+                    }
+                    for (std::thread &reader : readers)
+                    {
+                        reader.join();
+                    }
+                }
+            );
+            std::cout << ben;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkSynched()
+    {
+        benchmarkSynchedReads<ttl::SynchedData>("SynchedData");
+        benchmarkSynchedReads<ttl::ReaderPreferringData>("ReaderPreferringData");
+        benchmarkSynchedReads<ttl::FairData>("FairData");
+        benchmarkSynchedReads<ttl::ReaderBiasedData>("ReaderBiasedData");
+
+        struct Timestamps
+        {
+            std::int64_t first, last;
+        };
+        ttl::Synched<Timestamps> locked(Timestamps{1, 2});
+        ttl::Synched<Timestamps, ttl::SequenceData> sequenced(1, 2);
+        for (ttl::Sti_t threads = 1; threads <= 32; threads *= 2)
+        {
+            auto read_from = [threads](const char *name, std::function<std::int64_t()> read)
+            {
+                ttl::Benchmark ben(std::string("Synched<16 bytes> reads, ") + name + ", " + std::to_string(threads) + " threads x 1M", 3);
+                ben.run
+                (
+                    [&read, threads]()
+                    {
+                        std::vector<std::thread> readers;
+                        for (ttl::Sti_t i = 0; i < threads; ++i)
+                        {
+                            readers.emplace_back
+                            (
+                                [&read]()
+                                {
+                                    std::int64_t sum = 0;
+                                    for (int j = 0; j < 1000000; ++j)
+                                    {
+                                        sum += read();
+                                    }
+                                    if (sum == 0)
+                                    {
+                                        std::cout << "unreachable" << std::endl;
+                                    }
+                                }
+                            );
+                        }
+                        for (std::thread &reader : readers)
+                        {
+                            reader.join();
+                        }
+                    }
+                );
+                std::cout << ben;
+            };
+            read_from("SynchedData", [&locked]{return locked.getReadAccess()->last;});
+            read_from("SequenceData", [&sequenced]{return sequenced.load().last;});
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    template <typename LOOKUP>
+    void benchmarkLookups(const std::string &name, LOOKUP lookup)
+    {
+        for (ttl::Sti_t threads = 1; threads <= 32; threads *= 2)
+        {
+            ttl::Benchmark ben(name + ", " + std::to_string(threads) + " threads x 100k, 1 in 16 writes", 3);
+            ben.run
+            (
+                [&lookup, threads]()
+                {
+                    std::vector<std::thread> workers;
+                    for (ttl::Sti_t i = 0; i < threads; ++i)
+                    {
+                        workers.emplace_back
+                        (
+                            [&lookup, i]()
+                            {
+                                for (std::uint32_t j = 0; j < 100000; ++j)
+                                {
+                                    lookup(static_cast<int>((j * 2654435761u + i) % 4096), j % 16 == 0);
+                                }
+                            }
+                        );
+                    }
+                    for (std::thread &worker : workers)
+                    {
+                        worker.join();
+                    }
+                }
+            );
+            std::cout << ben;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkShardedSynched()
+    {
+        ttl::Synched<std::unordered_map<int, int>> whole;
+        benchmarkLookups
+        (
+            "Synched<unordered_map>",
+            [&whole](int key, bool write)
+            {
+                if (write)
+                {
+                    ++(*whole.getWriteAccess())[key];
+                }
+                else
+                {
+                    whole.getReadAccess()->count(key);
+                }
+            }
+        );
+
+        ttl::ShardedSynched<std::unordered_map<int, int>> sharded;
+        benchmarkLookups
+        (
+            "ShardedSynched<unordered_map>, " + std::to_string(sharded.getShardCount()) + " shards",
+            [&sharded](int key, bool write)
+            {
+                if (write)
+                {
+                    ++(*sharded.getWriteAccess(key))[key];
+                }
+                else
+                {
+                    sharded.getReadAccess(key)->count(key);
+                }
+            }
+        );
+    }
+
+    ////////////////////////////////////////////////////////////
+    template <typename PUSH, typename POP>
+    void benchmarkHandOver(const std::string &name, const ttl::Sti_t producers, const ttl::Sti_t consumers, PUSH push, POP pop)
+    {
+        // Producers hand over 64 items at a time, consumers pop until everything arrived
+        const ttl::Sti_t items = 1 << 20, batch = 64;
+        std::vector<ttl::Sti_t> values(batch, 1);
+        ttl::Benchmark ben(name + ", 1M items, " + std::to_string(producers) + " to " + std::to_string(consumers) + " threads", 1);
+        ben.run
+        (
+            [&]()
+            {
+                std::atomic<ttl::Sti_t> popped(0);
+                std::vector<std::thread> threads;
+                for (ttl::Sti_t p = 0; p < producers; ++p)
+                {
+                    threads.emplace_back
+                    (
+                        [&]()
+                        {
+                            for (ttl::Sti_t i = 0; i < items / producers; i += batch)
+                            {
+                                push(values.begin(), values.end());
+                            }
+                        }
+                    );
+                }
+                for (ttl::Sti_t c = 0; c < consumers; ++c)
+                {
+                    threads.emplace_back
+                    (
+                        [&]()
+                        {
+                            ttl::Sti_t received[batch];
+                            while (popped < items)
+                            {
+                                const ttl::Sti_t count = pop(received, batch);
+                                if (count == 0)
+                                {
+                                    std::this_thread::yield();
+                                }
+                                popped += count;
+                            }
+                        }
+                    );
+                }
+                for (std::thread &thread : threads)
+                {
+                    thread.join();
+                }
+            }
+        );
+        std::cout << ben;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkRings()
+    {
+        typedef std::vector<ttl::Sti_t>::iterator Iterator;
+        for (ttl::Sti_t threads : {1, 4})
+        {
+            ttl::Synched<std::deque<ttl::Sti_t>> deque;
+            benchmarkHandOver
+            (
+                "Synched<deque>", threads, threads,
+                [&deque](Iterator begin, Iterator end)
+                {
+                    for (; begin != end; ++begin)
+                    {
+                        deque.getWriteAccess()->push_back(*begin);
+                    }
+                },
+                [&deque](ttl::Sti_t *out, ttl::Sti_t)
+                {
+                    auto writer = deque.getWriteAccess();
+                    if (writer->empty())
+                    {
+                        return ttl::Sti_t(0);
+                    }
+                    *out = writer->front();
+                    writer->pop_front();
+                    return ttl::Sti_t(1);
+                }
+            );
+
+            ttl::MpmcRing<ttl::Sti_t> mpmc(1024);
+            benchmarkHandOver
+            (
+                "MpmcRing push and pop", threads, threads,
+                [&mpmc](Iterator begin, Iterator end)
+                {
+                    for (; begin != end; ++begin)
+                    {
+                        mpmc.waitPush(*begin);
+                    }
+                },
+                [&mpmc](ttl::Sti_t *out, ttl::Sti_t)
+                {
+                    return ttl::Sti_t(mpmc.pop(*out));
+                }
+            );
+            benchmarkHandOver
+            (
+                "MpmcRing pushN and popN", threads, threads,
+                [&mpmc](Iterator begin, Iterator end)
+                {
+                    mpmc.waitPushN(begin, end);
+                },
+                [&mpmc](ttl::Sti_t *out, ttl::Sti_t count)
+                {
+                    return mpmc.popN(out, count);
+                }
+            );
+        }
+
+        ttl::SpscRing<ttl::Sti_t> spsc(1024);
+        benchmarkHandOver
+        (
+            "SpscRing push and pop", 1, 1,
+            [&spsc](Iterator begin, Iterator end)
+            {
+                for (; begin != end; ++begin)
+                {
+                    spsc.waitPush(*begin);
+                }
+            },
+            [&spsc](ttl::Sti_t *out, ttl::Sti_t)
+            {
+                return ttl::Sti_t(spsc.pop(*out));
+            }
+        );
+        benchmarkHandOver
+        (
+            "SpscRing pushN and popN", 1, 1,
+            [&spsc](Iterator begin, Iterator end)
+            {
+                spsc.waitPushN(begin, end);
+            },
+            [&spsc](ttl::Sti_t *out, ttl::Sti_t count)
+            {
+                return spsc.popN(out, count);
+            }
+        );
+    }
+
+    ////////////////////////////////////////////////////////////
+    double spin(const ttl::Sti_t iterations)
+    {
+        double x = 1.0;
+        for (ttl::Sti_t i = 0; i < iterations; ++i)
+        {
+            x = std::sqrt(x + static_cast<double>(i));
+        }
+        return x;
+    }
+
+    ////////////////////////////////////////////////////////////
+    void benchmarkTaskGraph()
+    {
+        // 64 diamonds of parse, index and count, aggregate, with uneven costs
+        ttl::BatchWorker w(getHelperCount());
+        const ttl::Sti_t items = 64;
+        std::vector<double> results(items * 4);
+        auto cost = [](ttl::Sti_t item){return 2000 + item % 7 * 3000;};
+
+        ttl::TaskGraph graph;
+        for (ttl::Sti_t i = 0; i < items; ++i)
+        {
+            auto parse = graph.addTask([&results, cost, i]{results[i * 4] = spin(cost(i));});
+            auto index = graph.addTask([&results, cost, i]{results[i * 4 + 1] = spin(cost(i + 3));});
+            auto count = graph.addTask([&results, cost, i]{results[i * 4 + 2] = spin(cost(i + 5));});
+            auto aggregate = graph.addTask([&results, cost, i]{results[i * 4 + 3] = spin(cost(i + 1));});
+            graph.precede(parse, index);
+            graph.precede(parse, count);
+            graph.precede(index, aggregate);
+            graph.precede(count, aggregate);
+        }
+
+        ttl::Benchmark graphed("TaskGraph, 64 diamonds", 20);
+        graphed.run
+        (
+            [&w, &graph]()
+            {
+                graph.run(w);
+            }
+        );
+        std::cout << graphed;
+
+        std::vector<ttl::Sti_t> indices(items);
+        std::iota(indices.begin(), indices.end(), 0);
+        ttl::Benchmark staged("BatchWorker::fer with a barrier per stage, 64 diamonds", 20);
+        staged.run
+        (
+            [&w, &results, &indices, cost]()
+            {
+                w.fer(indices.begin(), indices.end(), [&results, cost](ttl::Sti_t i){results[i * 4] = spin(cost(i));});
+                w.fer(indices.begin(), indices.end(), [&results, cost](ttl::Sti_t i){results[i * 4 + 1] = spin(cost(i + 3)); results[i * 4 + 2] = spin(cost(i + 5));});
+                w.fer(indices.begin(), indices.end(), [&results, cost](ttl::Sti_t i){results[i * 4 + 3] = spin(cost(i + 1));});
+            }
+        );
+        std::cout << staged << "(checksum " << std::accumulate(results.begin(), results.end(), 0.0) << ")" << std::endl;
+    }
+
+} // Anonymous namespace
+
+
+int main()
+{
+    benchmarkBatchWorkerSchedules();
+    benchmarkBatchWorkerSmallRanges();
+    benchmarkBatchWorkerIrregular();
+    benchmarkMpscQueue();
+    benchmarkRings();
+    benchmarkFlareLatency();
+    benchmarkReduce();
+    benchmarkScan();
+    benchmarkSort();
+    benchmarkFind();
+    benchmarkBarrier();
+    benchmarkSynched();
+    benchmarkShardedSynched();
+    benchmarkTaskGraph();
+}
@@ -3,6 +3,66 @@
 
 #include "TTL/TTL.hpp"
 
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+
+namespace
+{
+    std::atomic<std::size_t> allocation_count(0);
+
+    void *allocate(std::size_t size, const std::size_t alignment = alignof(std::max_align_t)) noexcept
+    {
+        ++allocation_count;
+        if (alignment <= alignof(std::max_align_t))
+        {
+            return std::malloc(size != 0 ? size : 1);
+        }
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment + (size == 0 ? alignment : 0));
+    }
+
+    void *allocateOrThrow(std::size_t size, const std::size_t alignment = alignof(std::max_align_t))
+    {
+        if (void *memory = allocate(size, alignment))
+            return memory;
+        throw std::bad_alloc();
+    }
+}
+
+// Every replaceable form, so that aligned and array allocations are counted too
+void *operator new(std::size_t size) {return allocateOrThrow(size);}
+void *operator new[](std::size_t size) {return allocateOrThrow(size);}
+void *operator new(std::size_t size, std::align_val_t alignment) {return allocateOrThrow(size, static_cast<std::size_t>(alignment));}
+void *operator new[](std::size_t size, std::align_val_t alignment) {return allocateOrThrow(size, static_cast<std::size_t>(alignment));}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {return allocate(size);}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {return allocate(size);}
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {return allocate(size, static_cast<std::size_t>(alignment));}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {return allocate(size, static_cast<std::size_t>(alignment));}
+
+void operator delete(void *memory) noexcept {std::free(memory);}
+void operator delete[](void *memory) noexcept {std::free(memory);}
+void operator delete(void *memory, std::size_t) noexcept {std::free(memory);}
+void operator delete[](void *memory, std::size_t) noexcept {std::free(memory);}
+void operator delete(void *memory, std::align_val_t) noexcept {std::free(memory);}
+void operator delete[](void *memory, std::align_val_t) noexcept {std::free(memory);}
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {std::free(memory);}
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept {std::free(memory);}
+void operator delete(void *memory, const std::nothrow_t &) noexcept {std::free(memory);}
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {std::free(memory);}
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {std::free(memory);}
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {std::free(memory);}
+
 
 TEST_CASE ( "Argument Parser is Tested", "[Argument]" )
 {
@@ -96,3 +156,1366 @@ TEST_CASE ("Rit binary distribution", "[rit]")
 
 
 
+TEST_CASE ("BatchWorker schedules visit every element once", "[batchworker]")
+{
+    ttl::BatchWorker w(3);
+    std::vector<int> v(1000);
+    for (auto schedule : {ttl::BatchWorker::Schedule::Strided, ttl::BatchWorker::Schedule::Contiguous, ttl::BatchWorker::Schedule::Stealing})
+    {
+        w.setSchedule(schedule);
+
+        std::fill(v.begin(), v.end(), 0);
+        w.fer(v.begin(), v.end(), [](int &n){++n;});
+        REQUIRE ( std::count(v.begin(), v.end(), 1) == 1000 );
+
+        std::fill(v.begin(), v.end(), 0);
+        w.fir(ttl::Sit(0), ttl::Sit(90), [&v](std::size_t i, std::size_t thread){v[i] = thread + 1;}, true, true, 5);
+        for (std::size_t i = 0; i < v.size(); ++i)
+        {
+            REQUIRE ( (v[i] != 0) == (i < 90 && i % 5 == 0) );
+        }
+    }
+}
+
+
+TEST_CASE ("BatchWorker steals from a thread held up by a slow element", "[batchworker]")
+{
+    ttl::BatchWorker w(3);
+    w.setSchedule(ttl::BatchWorker::Schedule::Stealing);
+    const std::size_t count = 1000, participants = 4;
+    std::atomic<std::size_t> visits[participants] = {}, slow(participants);
+    w.fir
+    (
+        ttl::Sit(0), ttl::Sit(count), [&](std::size_t i, std::size_t thread)
+        {
+            if (i == 0)
+            {
+                slow = thread;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Longer than all others together
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(50)); // Every thread gets going before its range runs out
+            }
+            ++visits[thread];
+        }
+    );
+
+    REQUIRE ( slow < participants );
+    std::size_t total = 0;
+    for (std::atomic<std::size_t> &visited : visits)
+    {
+        total += visited;
+    }
+    REQUIRE ( total == count );
+    REQUIRE ( visits[slow] < count / participants / 4 ); // Its static share went to the others
+}
+
+
+TEST_CASE ("Flare wakes waiters that spin, sleep or give up", "[flare]")
+{
+    for (std::size_t spin_count : {0, 100000})
+    {
+        ttl::Flare flare(false, spin_count);
+        REQUIRE ( flare.getSpinCount() == spin_count );
+
+        flare.notify();
+        flare.wait(); // Skipped, the notification came first
+        REQUIRE ( flare.waitFor(std::chrono::milliseconds(5)) == false );
+
+        std::thread notifier([&flare]{std::this_thread::sleep_for(std::chrono::milliseconds(20)); flare.notify();});
+        flare.wait(); // Spins out, then sleeps
+        notifier.join();
+
+        notifier = std::thread([&flare]{std::this_thread::sleep_for(std::chrono::milliseconds(5)); flare.notify_all();});
+        REQUIRE ( flare.waitFor(std::chrono::seconds(10)) );
+        notifier.join();
+    }
+
+    ttl::Flare flare(true);
+    flare.setSpinCount(0);
+    REQUIRE ( flare.getSpinCount() == 0 );
+    flare.wait();
+    REQUIRE ( flare.waitFor(std::chrono::milliseconds(1)) == false );
+}
+
+
+TEST_CASE ("Flare may be destroyed as soon as wait returns", "[flare]")
+{
+    for (std::size_t spin_count : {0, 1000})
+    {
+        for (int i = 0; i < 2000; ++i)
+        {
+            ttl::Flare *flare = new ttl::Flare(false, spin_count);
+            std::thread notifier([flare]{flare->notify();});
+            flare->wait();
+            delete flare; // The notifier may not have returned yet
+            notifier.join();
+        }
+    }
+}
+
+
+TEST_CASE ("Worker runs all work issued from several threads", "[worker]")
+{
+    std::atomic<int> done(0);
+    {
+        ttl::Worker worker;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 4; ++p)
+        {
+            producers.emplace_back
+            (
+                [&worker, &done]()
+                {
+                    for (int i = 0; i < 10000; ++i)
+                    {
+                        worker.issueWork([&done](){++done;});
+                    }
+                }
+            );
+        }
+        for (std::thread &producer : producers)
+        {
+            producer.join();
+        }
+    }
+    REQUIRE ( done == 40000 );
+}
+
+
+TEST_CASE ("BatchWorker dispatches loops without allocating", "[batchworker]")
+{
+    ttl::BatchWorker w(3);
+    std::vector<float> v(10000);
+    double padding[8] = {};
+    for (auto schedule : {ttl::BatchWorker::Schedule::Strided, ttl::BatchWorker::Schedule::Contiguous, ttl::BatchWorker::Schedule::Stealing})
+    {
+        w.setSchedule(schedule);
+        const std::size_t before = allocation_count;
+        w.fer(v.begin(), v.end(), [padding](float &f){f += padding[0];});
+        w.fir(ttl::Sit(0), ttl::Sit(v.size()), [&v, padding](std::size_t i, std::size_t){v[i] += padding[7];});
+        w.fer(v.begin(), v.end(), [](float &f){++f;}, false);
+        w.fer(v.begin(), v.end(), [](float &f){++f;});
+        const std::size_t after = allocation_count;
+        REQUIRE ( after == before );
+    }
+    REQUIRE ( std::count(v.begin(), v.end(), 6.f) == 10000 );
+}
+
+
+TEST_CASE ("BatchWorker reductions combine elements in order", "[batchworker]")
+{
+    ttl::BatchWorker w(3);
+    std::vector<int> v(10007);
+    std::iota(v.begin(), v.end(), 0);
+    REQUIRE ( w.reduce(v.begin(), v.end(), 5, std::plus<int>()) == std::accumulate(v.begin(), v.end(), 5) );
+    REQUIRE ( w.reduce(v.begin(), v.begin(), 5, std::plus<int>()) == 5 );
+
+    std::string serial = "x";
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        serial += std::to_string(i % 10);
+    }
+    std::string parallel = w.transformReduce
+    (
+        ttl::Sit(0), ttl::Sit(1000), std::string("x"), std::plus<std::string>(),
+        [](std::size_t i){return std::to_string(i % 10);}
+    );
+    REQUIRE ( parallel == serial );
+}
+
+
+TEST_CASE ("BatchWorker scans match the serial prefix sums", "[batchworker]")
+{
+    ttl::BatchWorker w(3);
+    for (std::size_t size : {1, 2, 17, 10007})
+    {
+        std::vector<int> v(size), serial(size), parallel(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            v[i] = static_cast<int>(i % 7) - 3;
+        }
+
+        std::partial_sum(v.begin(), v.end(), serial.begin());
+        REQUIRE ( w.inclusiveScan(v.begin(), v.end(), parallel.begin(), std::plus<int>()) == parallel.end() );
+        REQUIRE ( parallel == serial );
+
+        serial[0] = 10;
+        std::partial_sum(v.begin(), v.end() - 1, serial.begin() + 1);
+        std::for_each(serial.begin() + 1, serial.end(), [](int &n){n += 10;});
+        w.exclusiveScan(v.begin(), v.end(), v.begin(), 10, std::plus<int>());
+        REQUIRE ( v == serial );
+    }
+}
+
+
+TEST_CASE ("BatchWorker sorts like std::sort", "[batchworker]")
+{
+    for (std::size_t workers : {0, 1, 3})
+    {
+        ttl::BatchWorker w(workers);
+        for (std::size_t size : {0, 1, 4096, 4097, 30011})
+        {
+            for (unsigned int range : {5u, 1000003u})
+            {
+                std::vector<unsigned int> v(size), serial;
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    v[i] = static_cast<unsigned int>(i * 2654435761u) % range;
+                }
+                serial = v;
+
+                std::sort(serial.begin(), serial.end());
+                w.sort(v.begin(), v.end());
+                REQUIRE ( v == serial );
+
+                std::reverse(serial.begin(), serial.end());
+                w.sort(v.begin(), v.end(), std::greater<unsigned int>());
+                REQUIRE ( v == serial );
+            }
+        }
+    }
+}
+
+
+TEST_CASE ("BatchWorker finds the first match and stops cancelled loops", "[batchworker]")
+{
+    for (std::size_t workers : {0, 1, 3})
+    {
+        ttl::BatchWorker w(workers);
+        std::vector<int> v(100000);
+        std::iota(v.begin(), v.end(), 0);
+        for (int target : {0, 1, 2047, 2048, 54321, 99999, 100000})
+        {
+            auto is_target = [target](int n){return n >= target && n % 7 == target % 7;};
+            REQUIRE ( w.findIf(v.begin(), v.end(), is_target) == std::find_if(v.begin(), v.end(), is_target) );
+            REQUIRE ( w.anyOf(v.begin(), v.end(), is_target) == (target < 100000) );
+        }
+        REQUIRE ( w.findIf(v.begin(), v.begin(), [](int){return true;}) == v.begin() );
+
+        typedef ttl::BatchWorker::Schedule Schedule;
+        for (Schedule schedule : {Schedule::Strided, Schedule::Contiguous, Schedule::Stealing})
+        {
+            w.setSchedule(schedule);
+            std::atomic<int> visited(0);
+            w.fer
+            (
+                v.begin(), v.end(), [&w, &visited](int n)
+                {
+                    ++visited;
+                    if (n == 10)
+                    {
+                        w.cancel();
+                    }
+                }
+            );
+            REQUIRE ( w.isCancelled() );
+            REQUIRE ( visited < 100000 );
+
+            visited = 0;
+            w.fer(v.begin(), v.end(), [&visited](int){++visited;});
+            REQUIRE ( w.isCancelled() == false );
+            REQUIRE ( visited == 100000 );
+        }
+    }
+}
+
+
+TEST_CASE ("BatchWorker waits for detached loops with a timeout", "[batchworker]")
+{
+    ttl::BatchWorker w(2);
+    std::vector<int> v(4);
+    std::atomic<int> visited(0);
+    w.fer
+    (
+        v.begin(), v.end(), [&visited](int)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            ++visited;
+        }, false, false
+    );
+    REQUIRE ( w.waitFor(std::chrono::milliseconds(1)) == false );
+    REQUIRE ( w.waitFor(std::chrono::seconds(10)) );
+    REQUIRE ( visited == 4 );
+    REQUIRE ( w.waitFor(std::chrono::nanoseconds(0)) );
+}
+
+
+TEST_CASE ("BatchWorker runs small loops on fewer threads", "[batchworker]")
+{
+    typedef ttl::BatchWorker::Schedule Schedule;
+    for (Schedule schedule : {Schedule::Strided, Schedule::Contiguous, Schedule::Stealing})
+    {
+        ttl::BatchWorker w(3);
+        w.setSchedule(schedule);
+        w.setMinimumBlockSize(1000);
+        REQUIRE ( w.getMinimumBlockSize() == 1000 );
+
+        for (std::size_t size : {1, 999, 1000, 2500, 100000})
+        {
+            std::vector<int> v(size);
+            std::vector<std::atomic<int>> used(4);
+            w.fir(v.begin(), v.end(), [&used](int &n, std::size_t id){++n; ++used[id];});
+            REQUIRE ( std::count(v.begin(), v.end(), 1) == static_cast<long>(size) );
+
+            std::size_t threads = 0;
+            for (std::atomic<int> &count : used)
+            {
+                threads += count != 0;
+            }
+            REQUIRE ( threads <= (size + 999) / 1000 );
+            if (size < 1000)
+            {
+                REQUIRE ( used[3] == static_cast<int>(size) );
+            }
+            REQUIRE ( w.reduce(v.begin(), v.end(), 0L, std::plus<long>()) == static_cast<long>(size) );
+        }
+    }
+}
+
+
+TEST_CASE ("BatchWorker keeps one scratch value per thread", "[batchworker]")
+{
+    for (std::size_t workers : {0, 1, 3})
+    {
+        ttl::BatchWorker w(workers);
+        auto counts = w.perWorker<long>(0);
+        auto owners = w.perWorker<std::size_t>(~std::size_t(0));
+        std::atomic<long> mismatched_ids(0);
+        std::vector<int> v(10000, 1);
+
+        for (int loop = 0; loop < 3; ++loop)
+        {
+            w.fir
+            (
+                v.begin(), v.end(), [&](int n, std::size_t id)
+                {
+                    counts.local() += n;
+                    std::size_t &owner = owners.local();
+                    if (owner == ~std::size_t(0))
+                    {
+                        owner = id;
+                    }
+                    mismatched_ids += owner != id;
+                }
+            );
+        }
+
+        REQUIRE ( counts.combine(0L, std::plus<long>()) == 3 * 10000 );
+        REQUIRE ( mismatched_ids == 0 );
+        std::size_t values = 0;
+        counts.forEach([&values](long &){++values;});
+        REQUIRE ( values <= workers + 1 );
+
+        counts.clear();
+        REQUIRE ( counts.combine(0L, std::plus<long>()) == 0 );
+        REQUIRE ( counts.local() == 0 );
+
+        w.setWorkerCount(workers + 2);
+        REQUIRE_THROWS_AS ( counts.local(), std::out_of_range ); // Outgrown, even with NDEBUG
+        auto grown = w.perWorker<long>(0);
+        w.fir(v.begin(), v.end(), [&grown](int n, std::size_t){grown.local() += n;});
+        REQUIRE ( grown.combine(0L, std::plus<long>()) == 10000 );
+    }
+}
+
+
+TEST_CASE ("BatchWorker runs nested loops on the same pool", "[batchworker]")
+{
+    typedef ttl::BatchWorker::Schedule Schedule;
+    for (Schedule schedule : {Schedule::Strided, Schedule::Contiguous, Schedule::Stealing})
+    {
+        ttl::BatchWorker w(3);
+        w.setSchedule(schedule);
+        std::vector<std::vector<int>> partitions(17, std::vector<int>(1000, 1));
+        std::atomic<long> total(0), mismatched_ids(0);
+
+        w.fir
+        (
+            partitions.begin(), partitions.end(), [&](std::vector<int> &partition, std::size_t id)
+            {
+                w.fir
+                (
+                    partition.begin(), partition.end(), [&mismatched_ids, id](int &n, std::size_t inner_id)
+                    {
+                        n *= 2;
+                        mismatched_ids += inner_id != id;
+                    }
+                );
+                total += w.reduce(partition.begin(), partition.end(), 0L, std::plus<long>());
+            }
+        );
+
+        REQUIRE ( total == 17 * 1000 * 2 );
+        REQUIRE ( mismatched_ids == 0 );
+    }
+}
+
+
+TEST_CASE ("BatchWorker waits for room instead of running functions inline", "[batchworker]")
+{
+    ttl::BatchWorker none(0);
+    bool ran = false;
+    REQUIRE ( none.tryIssueWork([&ran]{ran = true;}) == false );
+    REQUIRE ( ran == false );
+    none.issueWork([&ran]{ran = true;});
+    REQUIRE ( ran );
+
+    ttl::BatchWorker pool(2);
+    std::atomic<bool> release(false);
+    std::atomic<std::size_t> done(0), on_caller(0);
+    auto hold = [&release, &done]{while (release == false) std::this_thread::yield(); ++done;};
+    pool.issueWork(hold);
+    pool.issueWork(hold);
+    std::size_t queued = 2;
+    while (pool.tryIssueWork([&done]{++done;}))
+    {
+        ++queued;
+    }
+    REQUIRE ( queued > 1024 );
+
+    std::thread releaser([&release]{std::this_thread::sleep_for(std::chrono::milliseconds(20)); release = true;});
+    const std::thread::id caller = std::this_thread::get_id();
+    pool.issueWork([&, caller]{on_caller += std::this_thread::get_id() == caller; ++done;});
+    releaser.join();
+    while (done != queued + 1)
+    {
+        std::this_thread::yield();
+    }
+    REQUIRE ( on_caller == 0 );
+}
+
+
+TEST_CASE ("BatchWorker finishes queued functions before it goes away", "[batchworker]")
+{
+    std::atomic<int> done(0);
+    {
+        ttl::BatchWorker pool(2);
+        std::vector<int> v(100, 1);
+        for (int i = 0; i < 50; ++i)
+        {
+            pool.issueWork
+            (
+                [&pool, &done, &v]()
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    pool.fer(v.begin(), v.end(), [](int &){});
+                    pool.issueWork([&done]{++done;});
+                    ++done;
+                }
+            );
+        }
+        pool.setWorkerCount(1);
+        REQUIRE ( done == 100 );
+        for (int i = 0; i < 50; ++i)
+        {
+            pool.issueWork([&done]{std::this_thread::sleep_for(std::chrono::microseconds(200)); ++done;});
+        }
+    }
+    REQUIRE ( done == 150 );
+}
+
+
+TEST_CASE ("Barrier holds threads until all have arrived", "[barrier]")
+{
+    for (std::size_t spin_count : {0, 1000})
+    {
+        const std::size_t threads = 4, phases = 500;
+        ttl::Barrier barrier(threads, spin_count);
+        REQUIRE ( barrier.getThreadCount() == threads );
+        std::atomic<std::size_t> arrived(0), serial(0), mismatches(0);
+
+        auto run = [&]()
+        {
+            for (std::size_t phase = 0; phase < phases; ++phase)
+            {
+                ++arrived;
+                serial += barrier.wait();
+                mismatches += arrived < (phase + 1) * threads;
+                barrier.wait();
+            }
+        };
+        std::vector<std::thread> others;
+        for (std::size_t i = 1; i < threads; ++i)
+        {
+            others.emplace_back(run);
+        }
+        run();
+        for (std::thread &thread : others)
+        {
+            thread.join();
+        }
+
+        REQUIRE ( mismatches == 0 );
+        REQUIRE ( serial == phases );
+    }
+
+    for (std::size_t workers : {0, 1, 3})
+    {
+        ttl::BatchWorker w(workers);
+        std::vector<int> cells(1000, 1), next(1000);
+        std::atomic<std::size_t> calls(0);
+        w.parallel
+        (
+            [&](std::size_t index, std::size_t threads, ttl::Barrier &barrier)
+            {
+                ++calls;
+                const std::size_t first = cells.size() * index / threads;
+                const std::size_t last = cells.size() * (index + 1) / threads;
+                for (int step = 0; step < 100; ++step)
+                {
+                    for (std::size_t i = first; i < last; ++i)
+                    {
+                        next[i] = cells[i] + cells[(i + 1) % cells.size()];
+                    }
+                    barrier.wait();
+                    std::copy(next.begin() + first, next.begin() + last, cells.begin() + first);
+                    barrier.wait();
+                }
+            }
+        );
+        REQUIRE ( calls == workers + 1 );
+        REQUIRE ( std::count(cells.begin(), cells.end(), cells[0]) == 1000 );
+    }
+}
+
+
+TEST_CASE ("Barrier may be destroyed once the others have left wait", "[barrier]")
+{
+    for (std::size_t spin_count : {0, 1000})
+    {
+        for (int i = 0; i < 2000; ++i)
+        {
+            ttl::Barrier *barrier = new ttl::Barrier(2, spin_count);
+            std::thread last([barrier, i]{std::this_thread::sleep_for(std::chrono::microseconds(i % 50)); barrier->wait();});
+            if (barrier->wait())
+            {
+                last.join(); // It has not necessarily left wait yet
+                delete barrier;
+            }
+            else
+            {
+                delete barrier; // The last arrival may not have returned yet
+                last.join();
+            }
+        }
+    }
+}
+
+
+TEST_CASE ("Rings hand over elements in order and in batches", "[ring]")
+{
+    {
+        ttl::SpscRing<int> ring(5);
+        REQUIRE ( ring.getCapacity() == 8 );
+        std::vector<int> in {0, 1, 2, 3, 4, 5}, out(8);
+        REQUIRE ( ring.pushN(in.begin(), in.end()) == 6 );
+        REQUIRE ( ring.pushN(in.begin(), in.end()) == 2 );
+        REQUIRE ( ring.push(9) == false );
+        REQUIRE ( ring.popN(out.begin(), 7) == 7 );
+        REQUIRE ( out == std::vector<int>({0, 1, 2, 3, 4, 5, 0, 0}) );
+        int value = -1;
+        REQUIRE ( ring.pop(value) );
+        REQUIRE ( value == 1 );
+        REQUIRE ( ring.pop(value) == false );
+        REQUIRE ( ring.isEmpty() );
+    }
+    {
+        ttl::MpmcRing<int> ring(1);
+        REQUIRE ( ring.getCapacity() == 2 );
+        std::vector<int> in {7, 8, 9}, out(3);
+        REQUIRE ( ring.pushN(in.begin(), in.end()) == 2 );
+        REQUIRE ( ring.push(9) == false );
+        REQUIRE ( ring.popN(out.begin(), 3) == 2 );
+        REQUIRE ( out == std::vector<int>({7, 8, 0}) );
+        REQUIRE ( ring.isEmpty() );
+    }
+
+    const int items = 100000;
+    for (bool blocking : {false, true})
+    {
+        ttl::SpscRing<int> ring(64, blocking);
+        std::thread producer
+        (
+            [&ring]()
+            {
+                std::vector<int> batch(37);
+                for (int i = 0; i < items; i += 37)
+                {
+                    std::iota(batch.begin(), batch.end(), i);
+                    ring.waitPushN(batch.begin(), batch.begin() + std::min(37, items - i));
+                }
+            }
+        );
+        int expected = 0, out_of_order = 0, received[50];
+        while (expected < items)
+        {
+            const std::size_t count = ring.waitPopN(received, 50);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out_of_order += received[i] != expected++;
+            }
+        }
+        producer.join();
+        REQUIRE ( out_of_order == 0 );
+        REQUIRE ( ring.isEmpty() );
+    }
+
+    for (bool blocking : {false, true})
+    {
+        ttl::MpmcRing<int> ring(64, blocking);
+        std::atomic<long> sum(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back
+            (
+                [&ring, t]()
+                {
+                    std::vector<int> batch(10);
+                    for (int i = t * items; i < (t + 1) * items; i += 10)
+                    {
+                        if (i % 20 == 0)
+                        {
+                            std::iota(batch.begin(), batch.end(), i);
+                            ring.waitPushN(batch.begin(), batch.end());
+                        }
+                        else
+                        {
+                            for (int j = i; j < i + 10; ++j)
+                            {
+                                ring.waitPush(j);
+                            }
+                        }
+                    }
+                }
+            );
+            threads.emplace_back
+            (
+                [&ring, &sum]()
+                {
+                    int received[16], value;
+                    for (std::size_t remaining = items; remaining > 0;)
+                    {
+                        if (remaining % 2 == 0)
+                        {
+                            const std::size_t count = ring.waitPopN(received, std::min<std::size_t>(16, remaining));
+                            sum += std::accumulate(received, received + count, 0L);
+                            remaining -= count;
+                        }
+                        else
+                        {
+                            ring.waitPop(value);
+                            sum += value;
+                            --remaining;
+                        }
+                    }
+                }
+            );
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        REQUIRE ( sum == 4L * items * (4L * items - 1) / 2 );
+        REQUIRE ( ring.isEmpty() );
+    }
+}
+
+
+namespace
+{
+    template <typename POLICY>
+    void checkSynchedPolicy()
+    {
+        ttl::Synched<std::pair<long, long>, POLICY> pair(std::make_pair(0L, 0L));
+        std::atomic<long> torn(0), most_readers(0);
+
+        auto run = [&]()
+        {
+            for (int i = 0; i < 2000; ++i)
+            {
+                if (i % 4 == 0)
+                {
+                    auto writer = pair.getWriteAccess();
+                    ++writer->first;
+                    ++writer->second;
+                }
+                else
+                {
+                    auto reader = pair.getReadAccess();
+                    torn += reader->first != reader->second;
+                    most_readers = std::max<long>(most_readers, reader.getReaderCount());
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i)
+        {
+            threads.emplace_back(run);
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        REQUIRE ( torn == 0 );
+        REQUIRE ( most_readers >= 1 );
+        REQUIRE ( pair.getReaderCount() == 0 );
+        REQUIRE ( pair.getReadAccess()->first == 4 * 500 );
+    }
+
+    template <typename POLICY>
+    void checkTimedPolicy()
+    {
+        using namespace std::chrono;
+        ttl::Synched<int, POLICY> value(1);
+        auto elsewhere = [](std::function<bool()> attempt) -> bool
+        {
+            bool result = false;
+            std::thread([&]() {result = attempt();}).join();
+            return result;
+        };
+
+        {
+            auto writer = value.getWriteAccess();
+            REQUIRE ( elsewhere([&]() {return bool(value.tryGetReadAccess());}) == false );
+            REQUIRE ( elsewhere([&]() {return bool(value.tryGetReadAccess(milliseconds(5)));}) == false );
+            REQUIRE ( elsewhere([&]() {return bool(value.tryGetWriteAccess(milliseconds(5)));}) == false );
+        }
+        {
+            auto reader = value.getReadAccess();
+            REQUIRE ( elsewhere([&]() {return bool(value.tryGetWriteAccess(milliseconds(5)));}) == false );
+            REQUIRE ( elsewhere([&]() {return bool(value.tryGetReadAccess(milliseconds(5)));}) == true );
+        }
+        {
+            auto writer = value.tryGetWriteAccess();
+            REQUIRE ( bool(writer) );
+            *writer = 2;
+        }
+        REQUIRE ( *value.getReadAccess() == 2 );
+        REQUIRE ( value.getReaderCount() == 0 );
+    }
+}
+
+
+TEST_CASE ("Synched policies keep readers and writers apart", "[synched]")
+{
+    checkSynchedPolicy<ttl::SynchedData>();
+    checkSynchedPolicy<ttl::ReaderPreferringData>();
+    checkSynchedPolicy<ttl::FairData>();
+    checkSynchedPolicy<ttl::ReaderBiasedData>();
+}
+
+
+TEST_CASE ("Synched access can give up after a timeout", "[synched]")
+{
+    checkTimedPolicy<ttl::SynchedData>();
+    checkTimedPolicy<ttl::ReaderPreferringData>();
+    checkTimedPolicy<ttl::FairData>();
+    checkTimedPolicy<ttl::ReaderBiasedData>();
+}
+
+
+TEST_CASE ("ReaderBiasedData writers sleep while readers hold on", "[synched]")
+{
+    ttl::Synched<int, ttl::ReaderBiasedData> value(0);
+    std::atomic<int> reading(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i)
+    {
+        readers.emplace_back
+        (
+            [&value, &reading, i]()
+            {
+                auto reader = value.getReadAccess();
+                ++reading;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100 + 50 * i));
+            }
+        );
+    }
+    while (reading != 3)
+    {
+        std::this_thread::yield();
+    }
+
+    const std::clock_t before = std::clock();
+    *value.getWriteAccess() = 1;
+    const std::clock_t spent = std::clock() - before;
+    for (std::thread &reader : readers)
+    {
+        reader.join();
+    }
+    REQUIRE ( *value.getReadAccess() == 1 );
+    REQUIRE ( value.getReaderCount() == 0 );
+    REQUIRE ( spent < CLOCKS_PER_SEC / 20 );
+}
+
+
+namespace
+{
+    struct Version
+    {
+        Version(long value) : value(value), copy(value) {++alive;}
+        Version(const Version &other) : value(other.value), copy(other.copy) {++alive;}
+        ~Version() {--alive;}
+
+        long value, copy;
+        static std::atomic<long> alive;
+    };
+
+    std::atomic<long> Version::alive(0);
+}
+
+
+TEST_CASE ("SnapshotSynched readers keep their snapshot and never wait", "[synched]")
+{
+    {
+        ttl::SnapshotSynched<Version> data(0L);
+        std::atomic<long> torn(0), went_back(0);
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i)
+        {
+            threads.emplace_back
+            (
+                [&data, &torn, &went_back, i]()
+                {
+                    long last = 0;
+                    for (int j = 0; j < 2000; ++j)
+                    {
+                        if (i == 0 && j % 10 == 0)
+                        {
+                            auto writer = data.getWriteAccess();
+                            ++writer->value;
+                            ++writer->copy;
+                        }
+                        else
+                        {
+                            auto reader = data.getReadAccess();
+                            torn += reader->value != reader->copy;
+                            went_back += reader->value < last;
+                            last = reader->value;
+                        }
+                    }
+                }
+            );
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        REQUIRE ( torn == 0 );
+        REQUIRE ( went_back == 0 );
+        REQUIRE ( data.getReadAccess()->value == 200 );
+        REQUIRE ( data.getReaderCount() == 0 );
+        REQUIRE ( Version::alive == 1 );
+
+        auto old = data.getReadAccess();
+        std::thread writer([&data]{data.getWriteAccess()->value = -1;});
+        writer.join(); // Published without waiting for old
+        REQUIRE ( data.getReadAccess()->value == -1 );
+        REQUIRE ( old->value == 200 );
+        REQUIRE ( Version::alive == 2 );
+        {
+            auto moved(std::move(old)); // The last reader of 200 deletes it
+        }
+        REQUIRE ( Version::alive == 1 );
+
+        {
+            auto mine = data.getReadAccess();
+            for (long i = 1; i <= 3; ++i)
+            {
+                data.getWriteAccess()->value = i;
+                REQUIRE ( mine->value == -1 );
+            }
+            REQUIRE ( data.getReadAccess()->value == 3 );
+            REQUIRE ( Version::alive == 4 );
+        }
+        REQUIRE ( Version::alive == 1 );
+
+        auto held = data.getReadAccess();
+        data.getWriteAccess()->value = 4;
+    }
+    REQUIRE ( Version::alive == 0 );
+}
+
+
+TEST_CASE ("ShardedSynched spreads keys over independent shards", "[synched]")
+{
+    ttl::ShardedSynched<std::unordered_map<int, int>> map(5);
+    REQUIRE ( map.getShardCount() == 8 );
+    REQUIRE ( ttl::ShardedSynched<std::unordered_map<int, int>>(1).getShardIndex(12345) == 0 );
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back
+        (
+            [&map, i]()
+            {
+                for (int key = 0; key < 1000; ++key)
+                {
+                    ++(*map.getWriteAccess(key))[key];
+                    auto shard = map.getReadAccess((key * 7 + i) % 1000);
+                    shard->find(key);
+                }
+            }
+        );
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::size_t keys = 0, used_shards = 0;
+    for (std::size_t i = 0; i < map.getShardCount(); ++i)
+    {
+        auto shard = map.getShard(i).getReadAccess();
+        keys += shard->size();
+        used_shards += shard->empty() == false;
+        for (const std::pair<const int, int> &entry : *shard)
+        {
+            REQUIRE ( entry.second == 4 );
+            REQUIRE ( map.getShardIndex(entry.first) == i );
+        }
+    }
+    REQUIRE ( keys == 1000 );
+    REQUIRE ( used_shards == 8 );
+}
+
+
+TEST_CASE ("Sequence-locked Synched never shows a half-written value", "[synched]")
+{
+    struct Triple
+    {
+        long a, b, c;
+    };
+    ttl::Synched<Triple, ttl::SequenceData> triple(0L, 0L, 0L);
+    std::atomic<long> torn(0);
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i)
+    {
+        readers.emplace_back
+        (
+            [&]()
+            {
+                while (done == false)
+                {
+                    const Triple t = triple.load();
+                    torn += t.a != t.b || t.b != t.c;
+                    auto reader = triple.getReadAccess();
+                    torn += reader->a != reader->c;
+                }
+            }
+        );
+    }
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto writer = triple.getWriteAccess();
+        ++writer->a;
+        ++writer->b;
+        ++writer->c;
+    }
+    done = true;
+    for (std::thread &reader : readers)
+    {
+        reader.join();
+    }
+
+    REQUIRE ( torn == 0 );
+    REQUIRE ( triple.load().c == 20000 );
+    REQUIRE ( triple.getReaderCount() == 0 );
+    ttl::Synched<Triple, ttl::SequenceData> copy(triple);
+    REQUIRE ( copy.getReadAccess()->b == 20000 );
+}
+
+
+TEST_CASE ("Contention counts acquisitions and reports them by name", "[contention]")
+{
+    {
+        ttl::Contention first("Synched", "contention test"), second("Synched", "contention test");
+        first.addRead(std::chrono::microseconds(3), 2);
+        first.addWrite(std::chrono::microseconds(5));
+        second.addRead(std::chrono::microseconds(1), 4);
+        second.addHold(std::chrono::microseconds(7));
+        second.addTimeout();
+
+        const ttl::Contention::Counts counts = first.getCounts();
+        REQUIRE ( counts.reads == 1 );
+        REQUIRE ( counts.writes == 1 );
+        REQUIRE ( counts.read_wait == 3000 );
+        REQUIRE ( counts.max_wait == 5000 );
+        REQUIRE ( counts.max_readers == 2 );
+
+        const std::string report = ttl::Contention::getReport();
+        REQUIRE ( report.find("Synched \"contention test\": 2 reads, 1 writes, 2 reads per write") != std::string::npos );
+        REQUIRE ( report.find("max hold 7 µs, 4 readers at most, 1 timeouts") != std::string::npos );
+
+        first.reset();
+        REQUIRE ( first.getCounts().reads == 0 );
+    }
+    REQUIRE ( ttl::Contention::getReport().find("contention test") == std::string::npos );
+
+#ifdef TTL_CONTENTION
+    ttl::Synched<int> value(0);
+    value.setName("instrumented synched");
+    {
+        auto reader = value.getReadAccess();
+        auto other = value.getReadAccess();
+    }
+    *value.getWriteAccess() += 1;
+    const std::string report = ttl::Contention::getReport();
+    REQUIRE ( report.find("Synched \"instrumented synched\": 2 reads, 1 writes, 2 reads per write") != std::string::npos );
+    REQUIRE ( report.find("2 readers at most") != std::string::npos );
+#endif // TTL_CONTENTION
+}
+
+
+TEST_CASE ("TaskGraph runs tasks after their predecessors", "[taskgraph]")
+{
+    for (std::size_t workers : {0, 1, 4})
+    {
+        ttl::BatchWorker pool(workers);
+        ttl::TaskGraph graph;
+        std::atomic<int> order(0);
+        int parsed = 0, indexed = 0, counted = 0, aggregated = 0;
+
+        auto parse = graph.addTask([&]{parsed = ++order;});
+        auto index = graph.addTask([&]{indexed = ++order;});
+        auto count = graph.addTask([&]{counted = ++order;});
+        auto aggregate = graph.addTask([&]{aggregated = ++order;});
+        graph.precede(parse, index);
+        graph.precede(parse, count);
+        graph.precede(index, aggregate);
+        graph.precede(count, aggregate);
+
+        for (int run = 0; run < 3; ++run)
+        {
+            order = 0;
+            graph.run(pool);
+            REQUIRE ( parsed == 1 );
+            REQUIRE ( indexed > 1 );
+            REQUIRE ( counted > 1 );
+            REQUIRE ( aggregated == 4 );
+        }
+
+        graph.precede(aggregate, parse);
+        REQUIRE_THROWS_AS ( graph.run(pool), std::invalid_argument );
+    }
+}
+
+
+TEST_CASE ("TaskGraph runs from within the pool's own workers", "[taskgraph]")
+{
+    for (std::size_t workers : {1, 3})
+    {
+        ttl::BatchWorker pool(workers);
+        ttl::TaskGraph graph;
+        std::atomic<int> order(0);
+        int first = 0, left = 0, right = 0, last = 0;
+        auto a = graph.addTask([&]{first = ++order;});
+        auto b = graph.addTask([&]{left = ++order;});
+        auto c = graph.addTask([&]{right = ++order;});
+        auto d = graph.addTask([&]{last = ++order;});
+        graph.precede(a, b);
+        graph.precede(a, c);
+        graph.precede(b, d);
+        graph.precede(c, d);
+
+        ttl::Future<int> ran;
+        pool.issueWork(ran, [&]{graph.run(pool); return last;});
+        REQUIRE ( ran.get() == 4 );
+        REQUIRE ( first == 1 );
+        REQUIRE ( left > 1 );
+        REQUIRE ( right > 1 );
+    }
+}
+
+
+TEST_CASE ("TaskGraph tasks spread their loops over the other workers", "[taskgraph]")
+{
+    ttl::BatchWorker pool(4);
+    ttl::TaskGraph graph;
+    std::vector<int> values(64, 1);
+    std::atomic<unsigned> used(0);
+    std::atomic<long> total(0), bad_ids(0);
+
+    auto load = graph.addTask([&]{std::fill(values.begin(), values.end(), 1);});
+    auto scale = graph.addTask
+    (
+        [&]
+        {
+            pool.fir
+            (
+                values.begin(), values.end(), [&](int &n, std::size_t id)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    n *= 3;
+                    used |= 1u << id;
+                    bad_ids += id > pool.getWorkerCount();
+                }
+            );
+        }
+    );
+    auto sum = graph.addTask([&]{total = pool.reduce(values.begin(), values.end(), 0L, std::plus<long>());});
+    graph.precede(load, scale);
+    graph.precede(scale, sum);
+
+    for (int run = 0; run < 3; ++run)
+    {
+        used = 0;
+        graph.run(pool);
+        REQUIRE ( total == 64 * 3 );
+        REQUIRE ( bad_ids == 0 );
+        REQUIRE ( std::bitset<32>(used).count() > 1 );
+    }
+}
+
+
+TEST_CASE ("Futures receive results and run continuations", "[future]")
+{
+    ttl::Worker worker;
+    ttl::BatchWorker pool(2);
+
+    ttl::Future<int> answer;
+    ttl::Future<long> doubled;
+    ttl::Future<void> done;
+    const std::size_t before = allocation_count;
+    worker.issueWork(answer, []{return 21;});
+    answer.then([&pool, &doubled](int &n){pool.issueWork(doubled, [&n]{return 2L * n;});});
+    answer.wait();
+    REQUIRE ( doubled.get() == 42 );
+    pool.issueWork(done, []{});
+    done.wait();
+    const std::size_t after = allocation_count;
+    REQUIRE ( after == before );
+    REQUIRE ( answer.isReady() );
+
+    ttl::Future<int> late;
+    int seen = 0;
+    late.getPromise().setValue(5);
+    late.then([&seen](int n){seen = n;});
+    REQUIRE ( seen == 5 );
+    REQUIRE ( late.get() == 5 );
+}
+
+
+TEST_CASE ("BatchWorker keeps working when pinned", "[batchworker]")
+{
+    ttl::BatchWorker w(2);
+    std::vector<int> v(1000);
+    for (auto affinity : {ttl::BatchWorker::Affinity::Core, ttl::BatchWorker::Affinity::Node, ttl::BatchWorker::Affinity::None})
+    {
+        w.setAffinity(affinity);
+        w.setWorkerCount(w.getWorkerCount() + 1);
+        REQUIRE ( w.getAffinity() == affinity );
+        w.fer(v.begin(), v.end(), [](int &n){++n;});
+    }
+    REQUIRE ( std::count(v.begin(), v.end(), 3) == 1000 );
+}
+
+
+#ifdef __cpp_impl_coroutine
+namespace
+{
+    ttl::Task<int> doubleOnWorker(ttl::BatchWorker &pool, int n)
+    {
+        co_await ttl::schedule(pool);
+        co_return 2 * n;
+    }
+
+    ttl::Task<int> sumOfDoubles(ttl::BatchWorker &pool, std::vector<int> &v)
+    {
+        std::vector<ttl::Task<int>> tasks;
+        for (int n = 0; n < 10; ++n)
+        {
+            tasks.push_back(doubleOnWorker(pool, n));
+        }
+        std::vector<int> doubles = co_await ttl::whenAll(std::move(tasks));
+        co_await ttl::fer(pool, v.begin(), v.end(), [](int &n){++n;});
+        co_return std::accumulate(doubles.begin(), doubles.end(), 0);
+    }
+}
+
+TEST_CASE ("Coroutines resume on the pool and await each other", "[coroutine]")
+{
+    for (std::size_t workers : {0, 1, 3})
+    {
+        ttl::BatchWorker pool(workers);
+        std::vector<int> v(1000);
+        REQUIRE ( sumOfDoubles(pool, v).get() == 90 );
+        REQUIRE ( std::count(v.begin(), v.end(), 1) == 1000 );
+    }
+}
+
+namespace
+{
+    ttl::Task<std::size_t> countThreads(ttl::BatchWorker &pool, std::vector<int> &v)
+    {
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        co_await ttl::fer
+        (
+            pool, v.begin(), v.end(), [&mutex, &threads](int &n)
+            {
+                ++n;
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            }
+        );
+        co_return threads.size();
+    }
+
+    ttl::Task<void> cancelEarly(ttl::BatchWorker &pool, std::vector<int> &v)
+    {
+        co_await ttl::fer(pool, v.begin(), v.end(), [&pool](int &n){++n; pool.cancel();});
+    }
+
+    // Every row is incremented by a nested loop, counting the rows that left their thread
+    ttl::Task<int> nestRows(ttl::BatchWorker &pool, std::vector<std::vector<int>> &rows)
+    {
+        std::atomic<int> moved(0);
+        co_await ttl::fer
+        (
+            pool, rows.begin(), rows.end(), [&pool, &moved](std::vector<int> &row)
+            {
+                const std::thread::id outer = std::this_thread::get_id();
+                std::atomic<bool> left(false);
+                pool.fer(row.begin(), row.end(), [outer, &left](int &n){++n; left = left || std::this_thread::get_id() != outer;});
+                moved += left ? 1 : 0;
+            }
+        );
+        co_return moved.load();
+    }
+}
+
+TEST_CASE ("Coroutine loops are sized and cancelled like fer", "[coroutine]")
+{
+    ttl::BatchWorker pool(3);
+    std::vector<int> small(10);
+    REQUIRE ( countThreads(pool, small).get() == 1 ); // Less than one grain
+    REQUIRE ( std::count(small.begin(), small.end(), 1) == 10 );
+
+    pool.setMinimumBlockSize(100);
+    for (int i = 0; i < 20; ++i)
+    {
+        std::vector<int> v(250);
+        REQUIRE ( countThreads(pool, v).get() <= 3 );
+        REQUIRE ( std::count(v.begin(), v.end(), 1) == 250 );
+    }
+    pool.setMinimumBlockSize(0);
+
+    for (auto schedule : {ttl::BatchWorker::Schedule::Contiguous, ttl::BatchWorker::Schedule::Stealing})
+    {
+        pool.setSchedule(schedule);
+        std::vector<int> v(100000);
+        cancelEarly(pool, v).get();
+        REQUIRE ( std::count(v.begin(), v.end(), 1) < 100000 );
+        REQUIRE ( countThreads(pool, v).get() >= 1 ); // Not held back by the earlier cancel
+        REQUIRE ( std::count(v.begin(), v.end(), 0) == 0 );
+    }
+
+    pool.setSchedule(ttl::BatchWorker::Schedule::Contiguous);
+    std::vector<std::vector<int>> rows(64, std::vector<int>(10000));
+    REQUIRE ( nestRows(pool, rows).get() == 0 ); // Nested loops run on their participant
+    for (const std::vector<int> &row : rows)
+    {
+        REQUIRE ( std::count(row.begin(), row.end(), 1) == 10000 );
+    }
+}
+#endif // __cpp_impl_coroutine
+
+
+TEST_CASE ("Elastic BatchWorker grows under load and shrinks when idle", "[batchworker]")
+{
+    ttl::BatchWorker w;
+    w.setElasticity({1, 3, 1, std::chrono::milliseconds(1)});
+    REQUIRE ( w.getWorkerCount() == 1 );
+
+    std::atomic<int> done(0);
+    for (int i = 0; i < 100; ++i)
+    {
+        w.issueWork([&done]{std::this_thread::sleep_for(std::chrono::microseconds(100)); ++done;});
+    }
+    while (done != 100)
+    {
+        std::this_thread::yield();
+    }
+    REQUIRE ( w.getPeakWorkerCount() == 3 );
+
+    for (int tries = 0; tries < 1000 && w.getWorkerCount() > 1; ++tries)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE ( w.getWorkerCount() == 1 );
+
+    std::vector<int> v(1000);
+    w.fer(v.begin(), v.end(), [](int &n){++n;});
+    REQUIRE ( std::count(v.begin(), v.end(), 1) == 1000 );
+}
+
+
+namespace
+{
+    // Copying sleeps once when asked to, so that a loop that has counted
+    // its workers gives them time to retire before it hands out the blocks
+    struct SlowCopy
+    {
+        SlowCopy(long value) : value(value) {}
+        SlowCopy(const SlowCopy &other) : value(other.value)
+        {
+            if (sleep_once.exchange(false))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+        SlowCopy &operator=(const SlowCopy &) = default;
+
+        long value;
+        static std::atomic<bool> sleep_once;
+    };
+
+    std::atomic<bool> SlowCopy::sleep_once(false);
+}
+
+
+TEST_CASE ("Elastic BatchWorker loops survive workers retiring meanwhile", "[batchworker]")
+{
+    ttl::BatchWorker w;
+    w.setElasticity({0, 4, 0, std::chrono::milliseconds(1)});
+    std::vector<long> v(4096, 1);
+    for (int round = 0; round < 5; ++round)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            w.issueWork([]{});
+        }
+        SlowCopy::sleep_once = true;
+        const SlowCopy sum = w.transformReduce
+        (
+            v.begin(), v.end(), SlowCopy(0),
+            [](const SlowCopy &a, const SlowCopy &b){return SlowCopy(a.value + b.value);},
+            [](long n){return SlowCopy(n);}
+        );
+        REQUIRE ( sum.value == 4096 );
+
+        std::atomic<int> arrived(0), late(0);
+        w.parallel
+        (
+            [&arrived, &late](std::size_t, std::size_t threads, ttl::Barrier &barrier)
+            {
+                ++arrived;
+                barrier.wait();
+                late += arrived != static_cast<int>(threads);
+            }
+        );
+        REQUIRE ( late == 0 );
+    }
+}
+
+